@@ -0,0 +1,148 @@
+/*
+ * Channel-capacity report from recorded or live traces.
+ *
+ * Reads tx/rx records (see trace.h) from one merged trace, as written by
+ * ChannelRun, or from a sender trace and a receiver trace, aligns them by
+ * symbol index in a fixed window and feeds the pairs to the streaming
+ * estimator. "-" reads stdin, so a run in progress can be followed with
+ *
+ *     tail -f rx.trace | ./CapacityReport tx.trace - --every=1000
+ *
+ * Options: --symbol-us=N (default: measured from rx timestamps)
+ *          --every=N     print a running report every N aligned symbols
+ *          --decay=D     exponential forgetting factor, 0 < D <= 1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "capacity.h"
+#include "trace.h"
+
+#define ALIGN_WINDOW 4096  // symbols one side may run ahead of the other
+
+struct pending {
+    long symbol;  // -1: empty
+    int bit;
+};
+
+struct pending pending_tx[ALIGN_WINDOW];
+struct pending pending_rx[ALIGN_WINDOW];
+
+FILE *open_trace(const char *path) {
+    if (strcmp(path, "-") == 0) {
+        return stdin;
+    }
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+    return fp;
+}
+
+int main(int argc, char *argv[]) {
+    const char *paths[2] = {NULL};
+    int npaths = 0;
+    long symbol_us = 0, every = 0;
+    double decay = 1.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--symbol-us=", 12) == 0) {
+            symbol_us = atol(argv[i] + 12);
+        } else if (strncmp(argv[i], "--every=", 8) == 0) {
+            every = atol(argv[i] + 8);
+        } else if (strncmp(argv[i], "--decay=", 8) == 0) {
+            decay = atof(argv[i] + 8);
+        } else if ((argv[i][0] != '-' || strcmp(argv[i], "-") == 0) && npaths < 2) {
+            paths[npaths++] = argv[i];
+        } else {
+            npaths = 0;
+            break;
+        }
+    }
+    struct capacity_estimator est;
+    if (npaths == 0 || symbol_us < 0 || every < 0 || capacity_init(&est, 2, 0.0, decay) == -1) {
+        fprintf(stderr, "Usage: %s <trace> [<rx_trace>] [--symbol-us=N] [--every=N] [--decay=D]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+    // A given symbol period holds from the first line; otherwise the rate is
+    // estimated from the rx timestamps as they arrive
+    if (symbol_us) {
+        est.symbol_rate = 1e6 / (double)symbol_us;
+    }
+
+    FILE *files[2] = {open_trace(paths[0]), npaths > 1 ? open_trace(paths[1]) : NULL};
+    int open_files = npaths;
+    for (int i = 0; i < ALIGN_WINDOW; i++) {
+        pending_tx[i].symbol = pending_rx[i].symbol = -1;
+    }
+
+    int64_t first_rx_ns = 0, last_rx_ns = 0;
+    unsigned long long rx_count = 0, dropped = 0;
+
+    // Round-robin between the files so neither side runs ahead of the window
+    for (int f = 0; open_files > 0; f = (f + 1) % npaths) {
+        if (!files[f]) {
+            continue;
+        }
+        struct trace_record rec;
+        if (!trace_read(files[f], &rec)) {
+            if (files[f] != stdin) {
+                fclose(files[f]);
+            }
+            files[f] = NULL;
+            open_files--;
+            continue;
+        }
+        if (rec.symbol < 0) {
+            continue;
+        }
+
+        struct pending *mine = rec.kind == TRACE_TX ? pending_tx : pending_rx;
+        struct pending *other = rec.kind == TRACE_TX ? pending_rx : pending_tx;
+        struct pending *slot = &mine[rec.symbol % ALIGN_WINDOW];
+        struct pending *match = &other[rec.symbol % ALIGN_WINDOW];
+
+        if (rec.kind == TRACE_RX) {
+            if (rx_count++ == 0) {
+                first_rx_ns = rec.t_ns;
+            }
+            last_rx_ns = rec.t_ns;
+        }
+        int added = match->symbol == rec.symbol;
+        if (added) {
+            int sent = rec.kind == TRACE_TX ? rec.bit : match->bit;
+            int received = rec.kind == TRACE_RX ? rec.bit : match->bit;
+            capacity_add(&est, sent, received);
+            match->symbol = -1;
+        } else {
+            dropped += slot->symbol != -1;  // never matched within the window
+            slot->symbol = rec.symbol;
+            slot->bit = rec.bit;
+        }
+
+        if (added && every && est.symbols % every == 0) {
+            if (!symbol_us && rx_count > 1 && last_rx_ns > first_rx_ns) {
+                est.symbol_rate = (rx_count - 1) * 1e9 / (double)(last_rx_ns - first_rx_ns);
+            }
+            struct capacity_result result;
+            capacity_result(&est, &result);
+            printf("%llu symbols: BER %.3g, I(X;Y) %.1f bit/s, capacity %.1f bit/s\n",
+                   result.symbols, result.ber, result.mutual_info_bps, result.capacity_bps);
+            fflush(stdout);
+        }
+    }
+
+    if (!symbol_us && rx_count > 1 && last_rx_ns > first_rx_ns) {
+        est.symbol_rate = (rx_count - 1) * 1e9 / (double)(last_rx_ns - first_rx_ns);
+    }
+    printf("symbol rate %.1f/s\n", est.symbol_rate);
+    if (dropped) {
+        printf("%llu records had no counterpart within %d symbols\n", dropped, ALIGN_WINDOW);
+    }
+    capacity_print(&est, stdout, "capacity");
+    return EXIT_SUCCESS;
+}
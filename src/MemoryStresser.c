@@ -4,6 +4,7 @@ Run the program.
 From different terminal shell,
     We can track free memory using watch -n 1 "free -h"
     We can also track system PSI using watch -n 1 cat /proc/pressure/memory
+    Or, without polling processes: PSI_TELEMETRY=/psicovert ./MemoryStresser and ./TelemetryViewer
 
  */
 
@@ -14,8 +15,11 @@ From different terminal shell,
 #include <unistd.h>
 #include <sys/wait.h>
 
+#include "telemetry.h"
+
 #define CMD_BUFFER 256
 pid_t stress_ng_pid = 0;
+struct telemetry telemetry;
 
 void handle_signal(int sig) {
     if (stress_ng_pid > 0) {
@@ -73,7 +77,12 @@ int main() {
         exit(1);
     }
 
+    telemetry_open_from_env(&telemetry, "MemoryStresser");
+    telemetry_add_pid(&telemetry, stress_ng_pid);
+    telemetry_watch(&telemetry, "/proc/pressure/memory", NULL);
+
     // Parent process waits for the child to finish
     waitpid(stress_ng_pid, NULL, 0);
+    telemetry_close(&telemetry);
     return 0;
 }
@@ -22,11 +22,14 @@
 #include <sys/stat.h>
 #include <errno.h>
 
+#include "telemetry.h"
+
 #define CGROUP_PATH "/sys/fs/cgroup/memory_stress"  // Custom path for the cgroup
 #define MEMORY_LIMIT "1G"  // Memory limit to be set for the cgroup (1GB in this case)
 
 pid_t stress_ng_pid1 = 0;  // PID for the first stress-ng process
 pid_t stress_ng_pid2 = 0;  // PID for the second stress-ng process
+struct telemetry telemetry;  // live stats when PSI_TELEMETRY is set
 
 /**
  * Signal handler for graceful shutdown.
@@ -143,6 +146,8 @@ int main() {
     create_cgroup_if_not_exists();  // Create the cgroup if it doesn't already exist
     enable_memory_controller();  // Enable the memory controller for the cgroup
     set_memory_limit();  // Set the memory limit for the cgroup
+    telemetry_open_from_env(&telemetry, "MemoryStresserCgroup");  // Publish PSI and RSS instead of watch/cat
+    telemetry_watch(&telemetry, CGROUP_PATH "/memory.pressure", CGROUP_PATH);
 
     // Run two stress-ng processes concurrently to allocate 1024MB each
     run_stress_ng(1024);  // Run the first stress-ng process with 1GB memory allocation
@@ -0,0 +1,149 @@
+/*
+ * Receiver (attacker) for the PSI covert channel.
+ *
+ * Reads a pressure file once per symbol period and decodes a 1 whenever the
+ * "some" stall total grew by more than the threshold during that symbol.
+ * Only read access to the pressure file is needed, e.g.
+ * /sys/fs/cgroup/memory_stress/memory.pressure for CovertChannel3 --pulse.
+ *
+ *     ./PSIReceiver <pressure_file> <nbits> [symbol_ms] [threshold_us]
+ *                   [--rt] [--rt-cpu=N] [--rt-deadline] [--rt-prio=N] [--trace=<file>]
+ *                   [--expect=<bits>]
+ *
+ * Symbol i is the window [start + i*P, start + (i+1)*P) after the receiver's
+ * start, read at its end. The sender pulses at the start of each of its own
+ * symbols, so start the receiver first and have the sender's first symbol
+ * begin within P minus the pulse length after it: an earlier sender loses
+ * its first pulse, a later one straddles two windows or shifts every bit by
+ * whole symbols. The tx/rx traces share CLOCK_MONOTONIC and show the offset.
+ * With --expect=<bits> (the sender's bit string) each decoded symbol is fed
+ * to the capacity estimator and the report is printed at the end.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "capacity.h"
+#include "psi.h"
+#include "rt_timing.h"
+#include "telemetry.h"
+#include "trace.h"
+
+#define DEFAULT_SYMBOL_MS 100     // matches CovertChannel3 --pulse
+#define DEFAULT_THRESHOLD_US 500
+
+int main(int argc, char *argv[]) {
+    const char *positional[4] = {NULL};
+    const char *trace_path = NULL;
+    const char *expected = NULL;
+    int npositional = 0;
+    struct rt_options rt_opts;
+    rt_options_init(&rt_opts);
+
+    for (int i = 1; i < argc; i++) {
+        int consumed = rt_parse_option(argv[i], &rt_opts);
+        if (consumed == 1) {
+            continue;
+        }
+        if (consumed == 0 && strncmp(argv[i], "--trace=", 8) == 0) {
+            trace_path = argv[i] + 8;
+        } else if (consumed == 0 && strncmp(argv[i], "--expect=", 9) == 0) {
+            expected = argv[i] + 9;
+        } else if (consumed == 0 && argv[i][0] != '-' && npositional < 4) {
+            positional[npositional++] = argv[i];
+        } else {
+            npositional = -1;
+            break;
+        }
+    }
+    if (npositional < 2) {
+        fprintf(stderr, "Usage: %s <pressure_file> <nbits> [symbol_ms] [threshold_us]\n"
+                        "       [--rt] [--rt-cpu=N] [--rt-deadline] [--rt-prio=N] [--trace=<file>]\n"
+                        "       [--expect=<bits>]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char *pressure_path = positional[0];
+    long nbits = atol(positional[1]);
+    long symbol_ms = positional[2] ? atol(positional[2]) : DEFAULT_SYMBOL_MS;
+    long threshold_us = positional[3] ? atol(positional[3]) : DEFAULT_THRESHOLD_US;
+    if (nbits <= 0 || symbol_ms <= 0 || threshold_us < 0) {
+        fprintf(stderr, "Invalid bit count, symbol period or threshold\n");
+        return EXIT_FAILURE;
+    }
+    if (expected && strspn(expected, "01") != strlen(expected)) {
+        fprintf(stderr, "Expected bits must be a string of 0 and 1\n");
+        return EXIT_FAILURE;
+    }
+    struct capacity_estimator est;
+    capacity_init(&est, 2, 1000.0 / (double)symbol_ms, 1.0);
+
+    int psi_fd = psi_open(pressure_path);
+    if (psi_fd == -1) {
+        perror("Failed to open pressure file");
+        return EXIT_FAILURE;
+    }
+    struct trace trace;
+    if (trace_open(&trace, trace_path) == -1) {
+        perror("Failed to open trace");
+        return EXIT_FAILURE;
+    }
+    struct telemetry telemetry;
+    telemetry_open_from_env(&telemetry, "PSIReceiver");
+    telemetry_watch(&telemetry, pressure_path, NULL);
+
+    if (rt_enter(&rt_opts, symbol_ms * 1000000LL) == -1) {
+        return EXIT_FAILURE;
+    }
+
+    struct psi_sample prev, cur;
+    if (psi_read_fd(psi_fd, &prev) == -1) {
+        perror("Failed to read pressure file");
+        return EXIT_FAILURE;
+    }
+
+    struct symbol_clock clock;
+    if (symbol_clock_start(&clock, symbol_ms * 1000000LL) == -1) {
+        perror("Failed to start symbol clock");
+        return EXIT_FAILURE;
+    }
+
+    for (long i = 0; i < nbits; i++) {
+        if (symbol_clock_wait(&clock) == -1 || psi_read_fd(psi_fd, &cur) == -1) {
+            perror("Receiver failed");
+            break;
+        }
+        int64_t now = monotonic_ns();
+        unsigned long long some_delta = cur.some.total - prev.some.total;
+        unsigned long long full_delta = cur.full.total - prev.full.total;
+        int bit = some_delta > (unsigned long long)threshold_us;
+
+        putchar('0' + bit);
+        fflush(stdout);
+        trace_rx(&trace, now, i, bit, some_delta, full_delta);
+        int error = 0;
+        if (expected && i < (long)strlen(expected)) {
+            error = bit != expected[i] - '0';
+            capacity_add(&est, expected[i] - '0', bit);
+        }
+        telemetry_symbol(&telemetry, i, bit, error);
+        prev = cur;
+    }
+    putchar('\n');
+    fflush(stdout);
+
+    if (rt_opts.enabled) {
+        symbol_clock_report(&clock, stderr, "receiver");
+    }
+    if (expected) {
+        capacity_print(&est, stderr, "receiver");
+    }
+    symbol_clock_stop(&clock);
+    trace_close(&trace);
+    telemetry_close(&telemetry);
+    close(psi_fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,208 @@
+/*
+ * Finds the shortest memory-pressure pulse a PSI receiver can still detect.
+ *
+ * A pulse worker is placed in a pooled cgroup under /sys/fs/cgroup/memory_pulse
+ * with a resident buffer. For every pulse width in PULSE_WIDTHS_US the
+ * benchmark asks the worker for TRIALS pulses and measures how much the
+ * cgroup's "some" stall total grows across each one, exactly like a receiver
+ * sampling memory.pressure around a symbol. Idle windows of the longest width
+ * give the noise floor; a pulse counts as detected when its stall exceeds
+ * the noisiest idle window by NOISE_MARGIN_US. Widths are reported as the
+ * worker measured them (a pulse ends at a chunk boundary, see
+ * pressure_pulse.h); widths below one chunk are skipped.
+ *
+ * Needs root, cgroup v2 and swap or zram (see pressure_pulse.h).
+ *
+ *     sudo ./PulseBenchmark [amplitude_mb] [trials]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <errno.h>
+
+#include "cgroup_pool.h"
+#include "pressure_pulse.h"
+#include "psi.h"
+#include "telemetry.h"
+
+#define CGROUP_PATH "/sys/fs/cgroup/memory_pulse"
+#define MEMORY_LIMIT "1G"
+#define PULSE_BUFFER_MB 256
+#define DEFAULT_AMPLITUDE_MB 32
+#define DEFAULT_TRIALS 20
+#define NOISE_MARGIN_US 100
+#define DETECT_RATE 0.9
+#define SETTLE_MS 20  // gap between trials so pulses do not overlap
+
+static const long PULSE_WIDTHS_US[] = {100, 250, 500, 1000, 2000, 5000, 10000, 20000};
+#define NUM_WIDTHS (sizeof(PULSE_WIDTHS_US) / sizeof(PULSE_WIDTHS_US[0]))
+
+struct cgroup_pool pool;
+struct telemetry telemetry;
+
+void sleep_ms(long ms) {
+    struct timespec delay = {.tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000L};
+    nanosleep(&delay, NULL);
+}
+
+// Worker: joins the slot, keeps the buffer resident and serves pulse commands
+// until the command pipe is closed. Replies first with the chunk cost, then
+// with the measured width (or -errno) of every pulse.
+pid_t start_worker(struct cgroup_slot *slot, int cmd_fd[2], int reply_fd[2]) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork failed");
+        exit(EXIT_FAILURE);
+    }
+    if (pid > 0) {
+        close(cmd_fd[0]);
+        close(reply_fd[1]);
+        return pid;
+    }
+
+    close(cmd_fd[1]);
+    close(reply_fd[0]);
+    if (cgroup_pool_attach_self(slot) == -1) {
+        perror("Failed to write PID to cgroup");
+        _exit(EXIT_FAILURE);
+    }
+    pulse_worker_serve((size_t)PULSE_BUFFER_MB << 20, cmd_fd[0], reply_fd[1]);
+}
+
+// Returns the stall growth across one pulse; *width_us gets the measured
+// width, or -ERANGE if the requested width is below one chunk.
+unsigned long long measure_pulse(int psi_fd, int cmd_fd, int reply_fd,
+                                 const struct pulse_cmd *cmd, long *width_us) {
+    struct psi_sample before, after;
+    psi_read_fd(psi_fd, &before);
+    if (write(cmd_fd, cmd, sizeof(*cmd)) != sizeof(*cmd) ||
+        read(reply_fd, width_us, sizeof(*width_us)) != sizeof(*width_us)) {
+        fprintf(stderr, "Pulse worker died\n");
+        cgroup_pool_destroy(&pool);
+        exit(EXIT_FAILURE);
+    }
+    if (*width_us < 0 && *width_us != -ERANGE) {
+        fprintf(stderr, "Pulse worker failed to emit pulse: %s (MADV_PAGEOUT unsupported?)\n",
+                strerror((int)-*width_us));
+        cgroup_pool_destroy(&pool);
+        exit(EXIT_FAILURE);
+    }
+    psi_read_fd(psi_fd, &after);
+    return after.some.total - before.some.total;
+}
+
+unsigned long long measure_idle(int psi_fd, long window_us) {
+    struct psi_sample before, after;
+    psi_read_fd(psi_fd, &before);
+    struct timespec delay = {.tv_sec = window_us / 1000000,
+                             .tv_nsec = (window_us % 1000000) * 1000L};
+    nanosleep(&delay, NULL);
+    psi_read_fd(psi_fd, &after);
+    return after.some.total - before.some.total;
+}
+
+int main(int argc, char *argv[]) {
+    int amplitude_mb = argc > 1 ? atoi(argv[1]) : DEFAULT_AMPLITUDE_MB;
+    int trials = argc > 2 ? atoi(argv[2]) : DEFAULT_TRIALS;
+    if (argc > 3 || amplitude_mb <= 0 || amplitude_mb > PULSE_BUFFER_MB || trials <= 0) {
+        fprintf(stderr, "Usage: %s [amplitude_mb 1-%d] [trials]\n", argv[0], PULSE_BUFFER_MB);
+        return EXIT_FAILURE;
+    }
+
+    if (cgroup_pool_init(&pool, CGROUP_PATH, MEMORY_LIMIT "\n", "max\n", 1) == -1) {
+        return EXIT_FAILURE;
+    }
+    struct cgroup_slot *slot = cgroup_pool_acquire(&pool);
+
+    char pressure_path[256];
+    snprintf(pressure_path, sizeof(pressure_path), "%s/memory.pressure", slot->path);
+    int psi_fd = psi_open(pressure_path);
+    if (psi_fd == -1) {
+        perror("memory.pressure open failed");
+        cgroup_pool_destroy(&pool);
+        return EXIT_FAILURE;
+    }
+
+    int cmd_fd[2], reply_fd[2];
+    if (pipe(cmd_fd) == -1 || pipe(reply_fd) == -1) {
+        perror("pipe failed");
+        cgroup_pool_destroy(&pool);
+        return EXIT_FAILURE;
+    }
+    pid_t worker_pid = start_worker(slot, cmd_fd, reply_fd);
+    long chunk_us;
+    if (read(reply_fd[0], &chunk_us, sizeof(chunk_us)) != sizeof(chunk_us)) {
+        fprintf(stderr, "Pulse worker failed to start\n");
+        cgroup_pool_destroy(&pool);
+        return EXIT_FAILURE;
+    }
+    telemetry_open_from_env(&telemetry, "PulseBenchmark");
+    telemetry_watch(&telemetry, pressure_path, CGROUP_PATH);
+
+    // Noise floor: idle windows as long as the widest pulse
+    long idle_window_us = PULSE_WIDTHS_US[NUM_WIDTHS - 1];
+    unsigned long long noise = 0;
+    for (int t = 0; t < trials; t++) {
+        unsigned long long delta = measure_idle(psi_fd, idle_window_us);
+        if (delta > noise) {
+            noise = delta;
+        }
+        sleep_ms(SETTLE_MS);
+    }
+    unsigned long long threshold = noise + NOISE_MARGIN_US;
+
+    printf("amplitude %d MiB, %d trials, %d-page chunk %ld us, idle noise %llu us, threshold %llu us\n",
+           amplitude_mb, trials, PULSE_CHUNK_PAGES, chunk_us, noise, threshold);
+    printf("requested_us  measured_us  mean_stall_us  detected\n");
+
+    double shortest = -1.0;
+    for (size_t w = 0; w < NUM_WIDTHS; w++) {
+        struct pulse_cmd cmd = {.width_us = PULSE_WIDTHS_US[w],
+                                .amplitude = (size_t)amplitude_mb << 20,
+                                .reply = 1};
+        unsigned long long stall_sum = 0;
+        long width_sum = 0;
+        int detected = 0, t;
+        for (t = 0; t < trials; t++) {
+            long width_us;
+            unsigned long long delta = measure_pulse(psi_fd, cmd_fd[1], reply_fd[0], &cmd, &width_us);
+            if (width_us < 0) {
+                break;
+            }
+            stall_sum += delta;
+            width_sum += width_us;
+            detected += delta > threshold;
+            telemetry_symbol(&telemetry, (int64_t)(w * trials + t), delta > threshold, 0);
+            sleep_ms(SETTLE_MS);
+        }
+        if (t < trials) {
+            printf("%12ld  below one %d-page chunk\n", cmd.width_us, PULSE_CHUNK_PAGES);
+            continue;
+        }
+        double measured = (double)width_sum / trials;
+        printf("%12ld  %11.1f  %13.1f  %3d/%d\n", cmd.width_us, measured,
+               (double)stall_sum / trials, detected, trials);
+        if (detected >= DETECT_RATE * trials && (shortest < 0 || measured < shortest)) {
+            shortest = measured;
+        }
+    }
+
+    if (shortest >= 0) {
+        printf("shortest detectable pulse: %.0f us (measured)\n", shortest);
+    } else {
+        printf("no pulse width reached %.0f%% detection\n", DETECT_RATE * 100);
+    }
+
+    close(cmd_fd[1]);
+    close(reply_fd[0]);
+    close(psi_fd);
+    waitpid(worker_pid, NULL, 0);
+    telemetry_close(&telemetry);
+    cgroup_pool_destroy(&pool);
+    return EXIT_SUCCESS;
+}
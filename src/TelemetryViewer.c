@@ -0,0 +1,93 @@
+/*
+ * Live viewer for the telemetry ring published by the other binaries.
+ *
+ * Start any binary with PSI_TELEMETRY=/psicovert in its environment, then
+ * run this (no root needed, the ring is world-readable):
+ *
+ *     ./TelemetryViewer [/psicovert]
+ *
+ * Records are copied straight out of the shared mapping; the only syscall
+ * in the loop is the short sleep while the ring is idle.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+
+#include "telemetry.h"
+
+#define IDLE_SLEEP_US 1000
+#define DEFAULT_RING "/psicovert"
+
+volatile sig_atomic_t terminate_requested = 0;
+
+void handle_signal(int sig) {
+    terminate_requested = 1;
+}
+
+void print_record(const struct telemetry_record *rec) {
+    printf("%llu.%06llu %-14s %6d %s some=%llu full=%llu avg10=%.2f",
+           (unsigned long long)(rec->t_ns / 1000000000LL),
+           (unsigned long long)(rec->t_ns % 1000000000LL / 1000),
+           rec->role, rec->pid, rec->kind == TELEMETRY_SYMBOL ? "sym" : "smp",
+           (unsigned long long)rec->some_total_us, (unsigned long long)rec->full_total_us,
+           rec->some_avg10);
+    if (rec->symbol >= 0) {
+        printf(" symbol=%lld bit=%d bits=%llu errors=%llu", (long long)rec->symbol, rec->bit,
+               (unsigned long long)rec->bits, (unsigned long long)rec->bit_errors);
+    }
+    for (uint32_t i = 0; i < rec->nstressors && i < TELEMETRY_MAX_STRESSORS; i++) {
+        printf(" [%d %lluK]", rec->stressor_pid[i], (unsigned long long)rec->stressor_rss_kb[i]);
+    }
+    putchar('\n');
+}
+
+int main(int argc, char *argv[]) {
+    const char *name = argc > 1 ? argv[1] : getenv(TELEMETRY_ENV);
+    if (!name) {
+        name = DEFAULT_RING;
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    const struct telemetry_ring *ring = telemetry_map_readonly(name);
+    if (!ring) {
+        fprintf(stderr, "No telemetry ring %s (start a publisher with %s=%s)\n",
+                name, TELEMETRY_ENV, name);
+        return EXIT_FAILURE;
+    }
+
+    // Start from whatever is still in the ring
+    uint64_t head = atomic_load(&((struct telemetry_ring *)ring)->head);
+    uint64_t next = head > TELEMETRY_SLOTS ? head - TELEMETRY_SLOTS : 0;
+    struct timespec idle = {.tv_sec = 0, .tv_nsec = IDLE_SLEEP_US * 1000L};
+
+    while (!terminate_requested) {
+        head = atomic_load(&((struct telemetry_ring *)ring)->head);
+        if (next == head) {
+            fflush(stdout);
+            nanosleep(&idle, NULL);
+            continue;
+        }
+        if (head - next > TELEMETRY_SLOTS) {
+            printf("-- dropped %llu records\n", (unsigned long long)(head - TELEMETRY_SLOTS - next));
+            next = head - TELEMETRY_SLOTS;
+        }
+
+        struct telemetry_record rec;
+        int ret = telemetry_read(ring, next, &rec);
+        if (ret == 1) {
+            print_record(&rec);
+            next++;
+        } else if (ret == -1) {
+            next++;  // lapped while we were reading it
+        } else if (next + 1 < head) {
+            // Writer may still be inside this slot; come back once it is done
+            nanosleep(&idle, NULL);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,209 @@
+/*
+ * Kernel ground truth for the PSI channel (optional, needs libbpf; see
+ * psi_trace.bpf.c).
+ *
+ * memory.pressure only shows aggregates, so a wrong symbol cannot be told
+ * apart from a late pulse, a reclaim run or a late read. This tracer streams
+ * every PSI task state change, memstall section and direct/memcg reclaim run
+ * of the given cgroups and their descendants into the tx/rx trace format,
+ * with the same CLOCK_MONOTONIC timestamps the sender and receiver use:
+ *
+ *     sudo ./PSITrace --trace=kernel.trace /sys/fs/cgroup/memory_channel &
+ *     sudo ./ChannelRun --backend=real --bytes=16 --trace=channel.trace
+ *     sort -n -m channel.trace kernel.trace | less
+ *
+ * The cgroup trees are rescanned on every poll, so they may be created
+ * after the tracer starts. Stops on SIGINT/SIGTERM or after --duration-ms.
+ *
+ * Options: --trace=<file> (default stdout)  --duration-ms=N
+ */
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <linux/types.h>
+#include <bpf/bpf.h>
+#include <bpf/libbpf.h>
+
+#include "psi_trace.h"
+#include "psi_trace.skel.h"
+#include "rt_timing.h"
+#include "trace.h"
+
+#define MAX_ROOTS 16
+#define MAX_LINKS 16
+#define POLL_TIMEOUT_MS 100
+
+const char *event_names[PSI_EVENT_TYPES] = {
+    [PSI_EVENT_TASK_CHANGE] = "psi_change",
+    [PSI_EVENT_MEMSTALL_ENTER] = "memstall_enter",
+    [PSI_EVENT_MEMSTALL_LEAVE] = "memstall_leave",
+    [PSI_EVENT_DIRECT_RECLAIM_BEGIN] = "direct_reclaim_begin",
+    [PSI_EVENT_DIRECT_RECLAIM_END] = "direct_reclaim_end",
+    [PSI_EVENT_MEMCG_RECLAIM_BEGIN] = "memcg_reclaim_begin",
+    [PSI_EVENT_MEMCG_RECLAIM_END] = "memcg_reclaim_end",
+};
+
+volatile sig_atomic_t stop;
+int cgroup_map_fd = -1;
+int cgroups_traced;
+int map_full_reported;
+struct trace trace;
+unsigned long long event_counts[PSI_EVENT_TYPES];
+
+void handle_signal(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+// On cgroup v2 the directory's inode number is the id bpf_get_current_cgroup_id() returns
+int add_cgroup(const char *path, const struct stat *st, int type, struct FTW *ftw) {
+    (void)path;
+    (void)ftw;
+    if (type != FTW_D) {
+        return 0;
+    }
+    __u64 id = st->st_ino;
+    __u8 one = 1;
+    if (bpf_map_update_elem(cgroup_map_fd, &id, &one, BPF_NOEXIST) == 0) {
+        cgroups_traced++;
+    } else if (errno == E2BIG && !map_full_reported) {
+        fprintf(stderr, "More than %d cgroups; the rest are not traced\n", PSI_TRACE_MAX_CGROUPS);
+        map_full_reported = 1;
+    }
+    return 0;
+}
+
+void scan_cgroups(const char **roots, int nroots) {
+    for (int i = 0; i < nroots; i++) {
+        // A root that does not exist yet is picked up by a later scan
+        if (nftw(roots[i], add_cgroup, 8, FTW_PHYS) == -1 && errno != ENOENT) {
+            perror(roots[i]);
+        }
+    }
+}
+
+int handle_event(void *ctx, void *data, size_t size) {
+    (void)ctx;
+    const struct psi_trace_event *e = data;
+    if (size < sizeof(*e) || e->type >= PSI_EVENT_TYPES) {
+        return 0;
+    }
+    event_counts[e->type]++;
+    trace_event(&trace, (int64_t)e->t_ns, event_names[e->type], e->pid, e->cgroup_id,
+                e->arg0, e->arg1);
+    return 0;
+}
+
+unsigned long long read_dropped(struct psi_trace_bpf *skel) {
+    int ncpus = libbpf_num_possible_cpus();
+    if (ncpus <= 0) {
+        return 0;
+    }
+    __u64 *values = calloc((size_t)ncpus, sizeof(*values));
+    __u32 key = 0;
+    unsigned long long total = 0;
+    if (values && bpf_map_lookup_elem(bpf_map__fd(skel->maps.dropped), &key, values) == 0) {
+        for (int i = 0; i < ncpus; i++) {
+            total += values[i];
+        }
+    }
+    free(values);
+    return total;
+}
+
+int main(int argc, char *argv[]) {
+    const char *roots[MAX_ROOTS];
+    int nroots = 0;
+    const char *trace_path = "/dev/stdout";
+    long duration_ms = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--trace=", 8) == 0) {
+            trace_path = argv[i] + 8;
+        } else if (strncmp(argv[i], "--duration-ms=", 14) == 0) {
+            duration_ms = atol(argv[i] + 14);
+        } else if (argv[i][0] != '-' && nroots < MAX_ROOTS) {
+            roots[nroots++] = argv[i];
+        } else {
+            nroots = 0;
+            break;
+        }
+    }
+    if (nroots == 0 || duration_ms < 0) {
+        fprintf(stderr, "Usage: %s [--trace=<file>] [--duration-ms=N] <cgroup_dir>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    struct psi_trace_bpf *skel = psi_trace_bpf__open_and_load();
+    if (!skel) {
+        perror("Failed to load BPF object (needs root and a kernel with BTF)");
+        return EXIT_FAILURE;
+    }
+    cgroup_map_fd = bpf_map__fd(skel->maps.cgroup_ids);
+
+    // Attach one by one: a missing probe or tracepoint only loses that event
+    struct bpf_link *links[MAX_LINKS];
+    int nlinks = 0;
+    struct bpf_program *prog;
+    bpf_object__for_each_program(prog, skel->obj) {
+        struct bpf_link *link = bpf_program__attach(prog);
+        if (!link) {
+            fprintf(stderr, "Not tracing %s: %s\n", bpf_program__section_name(prog), strerror(errno));
+        } else if (nlinks < MAX_LINKS) {
+            links[nlinks++] = link;
+        }
+    }
+    if (nlinks == 0) {
+        fprintf(stderr, "No probe could be attached\n");
+        psi_trace_bpf__destroy(skel);
+        return EXIT_FAILURE;
+    }
+
+    if (trace_open(&trace, trace_path) == -1) {
+        perror("Failed to open trace");
+        psi_trace_bpf__destroy(skel);
+        return EXIT_FAILURE;
+    }
+    struct ring_buffer *rb = ring_buffer__new(bpf_map__fd(skel->maps.events), handle_event, NULL, NULL);
+    if (!rb) {
+        perror("Failed to create ring buffer");
+        trace_close(&trace);
+        psi_trace_bpf__destroy(skel);
+        return EXIT_FAILURE;
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+    int64_t end_ns = duration_ms ? monotonic_ns() + duration_ms * 1000000LL : 0;
+    while (!stop && (!end_ns || monotonic_ns() < end_ns)) {
+        scan_cgroups(roots, nroots);
+        int ret = ring_buffer__poll(rb, POLL_TIMEOUT_MS);
+        if (ret < 0 && ret != -EINTR) {
+            fprintf(stderr, "Ring buffer poll failed: %s\n", strerror(-ret));
+            break;
+        }
+        if (ret > 0 && trace.fp) {
+            fflush(trace.fp);  // keep a piped trace followable
+        }
+    }
+    ring_buffer__consume(rb);
+
+    fprintf(stderr, "%d cgroups traced, %llu events lost\n", cgroups_traced, read_dropped(skel));
+    for (int i = 0; i < PSI_EVENT_TYPES; i++) {
+        fprintf(stderr, "  %-22s %llu\n", event_names[i], event_counts[i]);
+    }
+
+    ring_buffer__free(rb);
+    trace_close(&trace);
+    for (int i = 0; i < nlinks; i++) {
+        bpf_link__destroy(links[i]);
+    }
+    psi_trace_bpf__destroy(skel);
+    return EXIT_SUCCESS;
+}
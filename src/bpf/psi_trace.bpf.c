@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Kernel half of PSITrace: records PSI task state changes, memstall sections
+ * and reclaim runs of the tasks in the traced cgroups.
+ *
+ * psi_task_change() and psi_memstall_enter/leave() are plain functions, not
+ * tracepoints, so they are hooked with kprobes; a kernel that inlined one of
+ * them still loads the object and PSITrace only warns that the probe is
+ * missing. Field offsets are relocated at load time (CO-RE), so one object
+ * runs on any kernel with BTF.
+ */
+#include "vmlinux.h"
+
+#include <bpf/bpf_core_read.h>
+#include <bpf/bpf_helpers.h>
+#include <bpf/bpf_tracing.h>
+
+#include "psi_trace.h"
+
+char LICENSE[] SEC("license") = "GPL";
+
+// Ids of the traced cgroups, filled and refreshed by userspace
+struct {
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, PSI_TRACE_MAX_CGROUPS);
+    __type(key, __u64);
+    __type(value, __u8);
+} cgroup_ids SEC(".maps");
+
+struct {
+    __uint(type, BPF_MAP_TYPE_RINGBUF);
+    __uint(max_entries, PSI_TRACE_RINGBUF_BYTES);
+} events SEC(".maps");
+
+// Events lost because the ring buffer was full
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, __u64);
+} dropped SEC(".maps");
+
+static __always_inline void emit(__u32 type, __u32 pid, __u64 cgroup_id, __u64 arg0, __u64 arg1) {
+    __u64 t_ns = bpf_ktime_get_ns();
+    if (!bpf_map_lookup_elem(&cgroup_ids, &cgroup_id)) {
+        return;
+    }
+    struct psi_trace_event *e = bpf_ringbuf_reserve(&events, sizeof(*e), 0);
+    if (!e) {
+        __u32 key = 0;
+        __u64 *count = bpf_map_lookup_elem(&dropped, &key);
+        if (count) {
+            (*count)++;
+        }
+        return;
+    }
+    e->t_ns = t_ns;
+    e->cgroup_id = cgroup_id;
+    e->arg0 = arg0;
+    e->arg1 = arg1;
+    e->pid = pid;
+    e->type = type;
+    bpf_ringbuf_submit(e, 0);
+}
+
+static __always_inline void emit_current(__u32 type, __u64 arg0, __u64 arg1) {
+    emit(type, (__u32)bpf_get_current_pid_tgid(), bpf_get_current_cgroup_id(), arg0, arg1);
+}
+
+// Called for wake-ups of other tasks too, so filter on the task's own cgroup
+SEC("kprobe/psi_task_change")
+int BPF_KPROBE(trace_psi_task_change, struct task_struct *task, int clear, int set) {
+    emit(PSI_EVENT_TASK_CHANGE, (__u32)BPF_CORE_READ(task, pid),
+         BPF_CORE_READ(task, cgroups, dfl_cgrp, kn, id), (__u32)clear, (__u32)set);
+    return 0;
+}
+
+SEC("kprobe/psi_memstall_enter")
+int BPF_KPROBE(trace_memstall_enter) {
+    emit_current(PSI_EVENT_MEMSTALL_ENTER, 0, 0);
+    return 0;
+}
+
+SEC("kprobe/psi_memstall_leave")
+int BPF_KPROBE(trace_memstall_leave) {
+    emit_current(PSI_EVENT_MEMSTALL_LEAVE, 0, 0);
+    return 0;
+}
+
+SEC("tracepoint/vmscan/mm_vmscan_direct_reclaim_begin")
+int trace_direct_reclaim_begin(struct trace_event_raw_mm_vmscan_direct_reclaim_begin_template *ctx) {
+    emit_current(PSI_EVENT_DIRECT_RECLAIM_BEGIN, (__u64)ctx->order, (__u64)ctx->gfp_flags);
+    return 0;
+}
+
+SEC("tracepoint/vmscan/mm_vmscan_direct_reclaim_end")
+int trace_direct_reclaim_end(struct trace_event_raw_mm_vmscan_direct_reclaim_end_template *ctx) {
+    emit_current(PSI_EVENT_DIRECT_RECLAIM_END, (__u64)ctx->nr_reclaimed, 0);
+    return 0;
+}
+
+// memory.max reclaim (try_to_free_mem_cgroup_pages), the channel's main stall source
+SEC("tracepoint/vmscan/mm_vmscan_memcg_reclaim_begin")
+int trace_memcg_reclaim_begin(struct trace_event_raw_mm_vmscan_direct_reclaim_begin_template *ctx) {
+    emit_current(PSI_EVENT_MEMCG_RECLAIM_BEGIN, (__u64)ctx->order, (__u64)ctx->gfp_flags);
+    return 0;
+}
+
+SEC("tracepoint/vmscan/mm_vmscan_memcg_reclaim_end")
+int trace_memcg_reclaim_end(struct trace_event_raw_mm_vmscan_direct_reclaim_end_template *ctx) {
+    emit_current(PSI_EVENT_MEMCG_RECLAIM_END, (__u64)ctx->nr_reclaimed, 0);
+    return 0;
+}
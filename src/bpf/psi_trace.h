@@ -0,0 +1,32 @@
+/*
+ * Record passed from psi_trace.bpf.c to PSITrace through the ring buffer.
+ * Included by both sides: the BPF object gets the __u* types from
+ * vmlinux.h, userspace from <linux/types.h>.
+ */
+#ifndef PSICOVERT_PSI_TRACE_H
+#define PSICOVERT_PSI_TRACE_H
+
+#define PSI_TRACE_MAX_CGROUPS 256
+#define PSI_TRACE_RINGBUF_BYTES (4 << 20)
+
+enum psi_trace_type {
+    PSI_EVENT_TASK_CHANGE,          // arg0: cleared flags, arg1: set flags
+    PSI_EVENT_MEMSTALL_ENTER,
+    PSI_EVENT_MEMSTALL_LEAVE,
+    PSI_EVENT_DIRECT_RECLAIM_BEGIN, // arg0: order, arg1: gfp flags
+    PSI_EVENT_DIRECT_RECLAIM_END,   // arg0: pages reclaimed
+    PSI_EVENT_MEMCG_RECLAIM_BEGIN,  // arg0: order, arg1: gfp flags
+    PSI_EVENT_MEMCG_RECLAIM_END,    // arg0: pages reclaimed
+    PSI_EVENT_TYPES,
+};
+
+struct psi_trace_event {
+    __u64 t_ns;       // bpf_ktime_get_ns(), i.e. CLOCK_MONOTONIC
+    __u64 cgroup_id;  // cgroup v2 id, the inode number of the cgroup directory
+    __u64 arg0;
+    __u64 arg1;
+    __u32 pid;        // kernel task id
+    __u32 type;       // enum psi_trace_type
+};
+
+#endif
@@ -0,0 +1,165 @@
+#include "capacity.h"
+
+#include <math.h>
+#include <string.h>
+
+#define BA_MAX_ITERATIONS 500
+#define BA_TOLERANCE 1e-9
+
+int capacity_init(struct capacity_estimator *est, int alphabet, double symbol_rate,
+                  double decay) {
+    if (alphabet < 2 || alphabet > CAPACITY_MAX_ALPHABET || symbol_rate < 0 ||
+        decay <= 0.0 || decay > 1.0) {
+        return -1;
+    }
+    memset(est, 0, sizeof(*est));
+    est->alphabet = alphabet;
+    est->symbol_rate = symbol_rate;
+    est->decay = decay;
+    return 0;
+}
+
+static int bits_per_symbol(int alphabet) {
+    int bits = 0;
+    while ((1 << bits) < alphabet) {
+        bits++;
+    }
+    return bits;
+}
+
+void capacity_add(struct capacity_estimator *est, int sent, int received) {
+    if (sent < 0 || sent >= est->alphabet || received < 0 || received >= est->alphabet) {
+        return;
+    }
+    if (est->decay < 1.0) {
+        for (int x = 0; x < est->alphabet; x++) {
+            for (int y = 0; y < est->alphabet; y++) {
+                est->counts[x][y] *= est->decay;
+            }
+        }
+        est->weight *= est->decay;
+        est->bit_errors *= est->decay;
+    }
+    est->counts[sent][received] += 1.0;
+    est->weight += 1.0;
+    est->bit_errors += __builtin_popcount((unsigned)(sent ^ received));
+    est->symbols++;
+}
+
+// Blahut-Arimoto over the rows that were actually sent
+static double channel_capacity(const struct capacity_estimator *est) {
+    int m = est->alphabet;
+    double p[CAPACITY_MAX_ALPHABET][CAPACITY_MAX_ALPHABET];  // p(y|x)
+    double r[CAPACITY_MAX_ALPHABET];                         // input distribution
+    int used = 0;
+
+    for (int x = 0; x < m; x++) {
+        double row = 0.0;
+        for (int y = 0; y < m; y++) {
+            row += est->counts[x][y];
+        }
+        r[x] = row > 0.0;
+        used += row > 0.0;
+        for (int y = 0; y < m; y++) {
+            p[x][y] = row > 0.0 ? est->counts[x][y] / row : 0.0;
+        }
+    }
+    if (used < 2) {
+        return 0.0;
+    }
+    for (int x = 0; x < m; x++) {
+        r[x] /= used;
+    }
+
+    double capacity = 0.0;
+    for (int iter = 0; iter < BA_MAX_ITERATIONS; iter++) {
+        double out[CAPACITY_MAX_ALPHABET] = {0};  // output distribution under r
+        for (int x = 0; x < m; x++) {
+            for (int y = 0; y < m; y++) {
+                out[y] += r[x] * p[x][y];
+            }
+        }
+
+        // D(p(.|x) || out) in bits; capacity is bracketed by sum r*D and max D
+        double d[CAPACITY_MAX_ALPHABET];
+        double lower = 0.0, upper = 0.0, norm = 0.0;
+        for (int x = 0; x < m; x++) {
+            d[x] = 0.0;
+            if (r[x] == 0.0) {
+                continue;
+            }
+            for (int y = 0; y < m; y++) {
+                if (p[x][y] > 0.0) {
+                    d[x] += p[x][y] * log2(p[x][y] / out[y]);
+                }
+            }
+            lower += r[x] * d[x];
+            upper = d[x] > upper ? d[x] : upper;
+        }
+        capacity = lower;
+        if (upper - lower < BA_TOLERANCE) {
+            break;
+        }
+        for (int x = 0; x < m; x++) {
+            r[x] *= exp2(d[x]);
+            norm += r[x];
+        }
+        for (int x = 0; x < m; x++) {
+            r[x] /= norm;
+        }
+    }
+    return capacity;
+}
+
+static double mutual_information(const struct capacity_estimator *est) {
+    int m = est->alphabet;
+    if (est->weight <= 0.0) {
+        return 0.0;
+    }
+    double px[CAPACITY_MAX_ALPHABET] = {0}, py[CAPACITY_MAX_ALPHABET] = {0};
+    for (int x = 0; x < m; x++) {
+        for (int y = 0; y < m; y++) {
+            px[x] += est->counts[x][y] / est->weight;
+            py[y] += est->counts[x][y] / est->weight;
+        }
+    }
+    double mi = 0.0;
+    for (int x = 0; x < m; x++) {
+        for (int y = 0; y < m; y++) {
+            double pxy = est->counts[x][y] / est->weight;
+            if (pxy > 0.0) {
+                mi += pxy * log2(pxy / (px[x] * py[y]));
+            }
+        }
+    }
+    return mi;
+}
+
+void capacity_result(const struct capacity_estimator *est, struct capacity_result *result) {
+    result->symbols = est->symbols;
+    result->ber = est->weight > 0.0
+                  ? est->bit_errors / (est->weight * bits_per_symbol(est->alphabet)) : 0.0;
+    result->mutual_info = mutual_information(est);
+    result->capacity = channel_capacity(est);
+    result->mutual_info_bps = result->mutual_info * est->symbol_rate;
+    result->capacity_bps = result->capacity * est->symbol_rate;
+}
+
+void capacity_print(const struct capacity_estimator *est, FILE *out, const char *label) {
+    struct capacity_result result;
+    capacity_result(est, &result);
+
+    fprintf(out, "%s: confusion matrix (rows sent, columns received%s)\n", label,
+            est->decay < 1.0 ? ", decayed" : "");
+    for (int x = 0; x < est->alphabet; x++) {
+        fprintf(out, "%s:   %2d |", label, x);
+        for (int y = 0; y < est->alphabet; y++) {
+            fprintf(out, " %10.0f", est->counts[x][y]);
+        }
+        fputc('\n', out);
+    }
+    fprintf(out, "%s: %llu symbols, BER %.3g, I(X;Y) %.4f bit/symbol (%.1f bit/s), "
+                 "capacity %.4f bit/symbol (%.1f bit/s)\n",
+            label, result.symbols, result.ber, result.mutual_info, result.mutual_info_bps,
+            result.capacity, result.capacity_bps);
+}
@@ -0,0 +1,59 @@
+/*
+ * Streaming channel-capacity and confusion-matrix estimator.
+ *
+ * Fed one (sent, received) symbol pair at a time, it keeps only an M x M
+ * matrix of counts, so memory stays bounded however long the run is and
+ * capacity_add() is a handful of arithmetic operations, cheap enough to
+ * call inline in the receiver loop. With decay < 1 the counts are
+ * exponentially forgotten (effective window 1 / (1 - decay) symbols), so
+ * the estimate follows configuration changes during a live run.
+ *
+ * Reported per snapshot: bit-error rate, mutual information per symbol under
+ * the observed input distribution, and the Shannon capacity of the estimated
+ * transition matrix (Blahut-Arimoto), both also in bits/s.
+ */
+#ifndef PSICOVERT_CAPACITY_H
+#define PSICOVERT_CAPACITY_H
+
+#include <stdio.h>
+
+#define CAPACITY_MAX_ALPHABET 16
+
+struct capacity_estimator {
+    int alphabet;
+    double symbol_rate;  // symbols per second
+    double decay;        // 1.0 keeps everything
+    double counts[CAPACITY_MAX_ALPHABET][CAPACITY_MAX_ALPHABET];  // [sent][received]
+    double weight;       // sum of counts
+    double bit_errors;   // decayed like the counts
+    unsigned long long symbols;
+};
+
+struct capacity_result {
+    unsigned long long symbols;
+    double ber;
+    double mutual_info;    // bits per symbol
+    double capacity;       // bits per symbol
+    double mutual_info_bps;
+    double capacity_bps;
+};
+
+/**
+ * alphabet is 2..CAPACITY_MAX_ALPHABET. Returns 0 or -1 on bad arguments.
+ */
+int capacity_init(struct capacity_estimator *est, int alphabet, double symbol_rate,
+                  double decay);
+
+/**
+ * Adds one aligned pair. Symbols outside the alphabet are ignored.
+ */
+void capacity_add(struct capacity_estimator *est, int sent, int received);
+
+void capacity_result(const struct capacity_estimator *est, struct capacity_result *result);
+
+/**
+ * Prints the confusion matrix and a one-line summary.
+ */
+void capacity_print(const struct capacity_estimator *est, FILE *out, const char *label);
+
+#endif
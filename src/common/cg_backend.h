@@ -0,0 +1,83 @@
+/*
+ * Pluggable backend under the cgroup and PSI calls of the channel.
+ *
+ * "real" builds its groups as a cgroup_pool under /sys/fs/cgroup, reads
+ * memory.pressure and runs resident pulse workers as processes inside the
+ * slots; it needs root and cgroup v2, and every symbol costs wall-clock time.
+ *
+ * "sim" keeps everything in-process: groups and knobs live in a table,
+ * workloads are modelled by their resident size, and a virtual clock
+ * integrates reclaim stalls (demand above memory.max), refault stalls from
+ * pulses and background noise into PSI some/full totals. The avg10/60/300
+ * values follow the kernel's fixed-point decay every 2 s of virtual time.
+ * sleep_until() only advances the virtual clock, so a run over megabytes of
+ * payload takes seconds and needs no privileges.
+ *
+ * Groups come as a root with nslots child groups <root>/slot0 ..
+ * <root>/slot<nslots-1>. Each slot hosts at most one workload. Pressure read
+ * on a group covers its whole subtree, as in the kernel.
+ */
+#ifndef PSICOVERT_CG_BACKEND_H
+#define PSICOVERT_CG_BACKEND_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "psi.h"
+
+#define CG_BACKEND_ENV "PSI_BACKEND"
+
+struct cg_backend {
+    const char *name;
+    // Creates root with memory.max = memory_max and nslots empty slots below
+    // it; whatever an earlier run left there is killed first.
+    int (*make_groups)(const char *root, const char *memory_max, int nslots);
+    // Stops every workload below root and removes root and its slots.
+    void (*remove_groups)(const char *root);
+    int (*write_knob)(const char *path, const char *knob, const char *value);
+    int (*read_pressure)(const char *path, struct psi_sample *sample);
+    // Stops every workload in the subtree and waits until it is empty.
+    int (*kill_group)(const char *path);
+    // Starts a workload in the slot at path that keeps bytes resident.
+    int (*set_load)(const char *path, size_t bytes);
+    // Asks the workload in path for one page-out/refault pulse; returns at once.
+    int (*pulse)(const char *path, size_t amplitude, int64_t width_ns);
+    // Longest such a pulse can last: pulses end at the first page-out chunk
+    // boundary after width_ns. -1 with errno ERANGE if width_ns is below one chunk.
+    int64_t (*pulse_length_ns)(const char *path, size_t amplitude, int64_t width_ns);
+    int64_t (*now_ns)(void);
+    int (*sleep_until)(int64_t deadline_ns);
+};
+
+struct sim_params {
+    uint64_t seed;
+    int64_t refault_ns_per_page;   // swap-in cost of one re-touched page
+    int64_t pageout_ns_per_page;   // MADV_PAGEOUT cost, not a memstall
+    double noise_fraction;         // mean share of time lost to unrelated stalls
+};
+
+extern const struct cg_backend cg_backend_real;
+extern const struct cg_backend cg_backend_sim;
+
+/**
+ * Returns the backend called name ("real" or "sim"); NULL name falls back
+ * to $PSI_BACKEND and then to "real". Returns NULL for unknown names.
+ */
+const struct cg_backend *cg_backend_select(const char *name);
+
+/**
+ * Returns nonzero if path is root or a cgroup below it.
+ */
+int cg_in_subtree(const char *path, const char *root);
+
+/**
+ * Default model parameters (zram-like refault cost, 0.2% noise).
+ */
+void sim_params_default(struct sim_params *params);
+
+/**
+ * Resets the simulation: drops all groups and restarts the virtual clock.
+ */
+void sim_backend_configure(const struct sim_params *params);
+
+#endif
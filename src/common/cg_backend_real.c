@@ -0,0 +1,218 @@
+#include "cg_backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/wait.h>
+
+#include "cgroup_pool.h"
+#include "pressure_pulse.h"
+#include "rt_timing.h"
+
+#define REAL_MAX_WORKERS 8
+
+struct real_worker {
+    char path[CGROUP_POOL_PATH_MAX];
+    pid_t pid;
+    int cmd_fd;
+    int64_t chunk_ns;  // calibrated by the worker once its buffer is resident
+};
+
+static struct real_worker workers[REAL_MAX_WORKERS];
+static int nworkers;
+static struct cgroup_pool pool;  // groups of the running channel
+
+int cg_in_subtree(const char *path, const char *root) {
+    size_t len = strlen(root);
+    return strncmp(path, root, len) == 0 && (path[len] == '\0' || path[len] == '/');
+}
+
+static int real_read_pressure(const char *path, struct psi_sample *sample) {
+    // Receivers read the same group every symbol, so keep its file open.
+    static char cached_path[CGROUP_POOL_PATH_MAX];
+    static int cached_fd = -1;
+    if (cached_fd == -1 || strcmp(cached_path, path) != 0) {
+        if (cached_fd != -1) {
+            close(cached_fd);
+        }
+        char pressure_path[CGROUP_POOL_PATH_MAX + 32];
+        snprintf(pressure_path, sizeof(pressure_path), "%s/memory.pressure", path);
+        cached_fd = psi_open(pressure_path);
+        if (cached_fd == -1) {
+            return -1;
+        }
+        snprintf(cached_path, sizeof(cached_path), "%s", path);
+    }
+    return psi_read_fd(cached_fd, sample);
+}
+
+static int real_kill_group(const char *path) {
+    int ret = cgroup_kill_and_wait(path, CGROUP_POOL_KILL_TIMEOUT_MS);
+    for (int i = 0; i < nworkers;) {
+        if (cg_in_subtree(workers[i].path, path)) {
+            close(workers[i].cmd_fd);
+            waitpid(workers[i].pid, NULL, 0);
+            workers[i] = workers[--nworkers];
+        } else {
+            i++;
+        }
+    }
+    return ret;
+}
+
+static int real_make_groups(const char *root, const char *memory_max, int nslots) {
+    if (pool.root[0] != '\0') {
+        errno = EBUSY;
+        return -1;
+    }
+    return cgroup_pool_init(&pool, root, memory_max, "max\n", nslots);
+}
+
+static void real_remove_groups(const char *root) {
+    real_kill_group(root);
+    if (strcmp(pool.root, root) == 0) {
+        cgroup_pool_destroy(&pool);
+    }
+}
+
+static const struct cgroup_slot *find_slot(const char *path) {
+    for (int i = 0; i < pool.nslots; i++) {
+        if (strcmp(pool.slots[i].path, path) == 0) {
+            return &pool.slots[i];
+        }
+    }
+    errno = ENOENT;
+    return NULL;
+}
+
+// Same resident-buffer worker as PulseBenchmark, fed over a pipe.
+static void run_worker(const struct cgroup_slot *slot, size_t bytes, int cmd_fd, int reply_fd) {
+    if (cgroup_pool_attach_self(slot) == -1) {
+        perror("Failed to join cgroup");
+        _exit(EXIT_FAILURE);
+    }
+    pulse_worker_serve(bytes, cmd_fd, reply_fd);
+}
+
+static struct real_worker *find_worker(const char *path) {
+    for (int i = 0; i < nworkers; i++) {
+        if (strcmp(workers[i].path, path) == 0) {
+            return &workers[i];
+        }
+    }
+    errno = ESRCH;
+    return NULL;
+}
+
+static int real_set_load(const char *path, size_t bytes) {
+    const struct cgroup_slot *slot = find_slot(path);
+    if (!slot) {
+        return -1;
+    }
+    if (nworkers == REAL_MAX_WORKERS) {
+        errno = ENOSPC;
+        return -1;
+    }
+    int fds[2], reply[2];
+    if (pipe(fds) == -1) {
+        return -1;
+    }
+    if (pipe(reply) == -1) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        close(reply[0]);
+        close(reply[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        close(fds[1]);
+        close(reply[0]);
+        run_worker(slot, bytes, fds[0], reply[1]);
+    }
+    close(fds[0]);
+    close(reply[1]);
+
+    // Wait until the buffer is resident and the chunk cost is known
+    long chunk_us;
+    ssize_t n = read(reply[0], &chunk_us, sizeof(chunk_us));
+    close(reply[0]);
+    if (n != sizeof(chunk_us)) {
+        close(fds[1]);
+        waitpid(pid, NULL, 0);
+        errno = ECHILD;
+        return -1;
+    }
+
+    struct real_worker *w = &workers[nworkers++];
+    snprintf(w->path, sizeof(w->path), "%s", path);
+    w->pid = pid;
+    w->cmd_fd = fds[1];
+    w->chunk_ns = chunk_us * 1000LL;
+    return 0;
+}
+
+static int real_pulse(const char *path, size_t amplitude, int64_t width_ns) {
+    struct real_worker *w = find_worker(path);
+    if (!w) {
+        return -1;
+    }
+    struct pulse_cmd cmd = {.amplitude = amplitude, .width_us = (long)(width_ns / 1000)};
+    return write(w->cmd_fd, &cmd, sizeof(cmd)) == sizeof(cmd) ? 0 : -1;
+}
+
+static int64_t real_pulse_length_ns(const char *path, size_t amplitude, int64_t width_ns) {
+    (void)amplitude;
+    struct real_worker *w = find_worker(path);
+    if (!w) {
+        return -1;
+    }
+    if (width_ns < w->chunk_ns) {
+        errno = ERANGE;
+        return -1;
+    }
+    return width_ns + w->chunk_ns;
+}
+
+static int real_sleep_until(int64_t deadline_ns) {
+    struct timespec deadline = {.tv_sec = deadline_ns / 1000000000LL,
+                                .tv_nsec = deadline_ns % 1000000000LL};
+    int ret;
+    while ((ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL)) == EINTR) {}
+    return ret == 0 ? 0 : -1;
+}
+
+const struct cg_backend cg_backend_real = {
+    .name = "real",
+    .make_groups = real_make_groups,
+    .remove_groups = real_remove_groups,
+    .write_knob = cgroup_write_knob,
+    .read_pressure = real_read_pressure,
+    .kill_group = real_kill_group,
+    .set_load = real_set_load,
+    .pulse = real_pulse,
+    .pulse_length_ns = real_pulse_length_ns,
+    .now_ns = monotonic_ns,
+    .sleep_until = real_sleep_until,
+};
+
+const struct cg_backend *cg_backend_select(const char *name) {
+    if (!name) {
+        name = getenv(CG_BACKEND_ENV);
+    }
+    if (!name || strcmp(name, "real") == 0) {
+        return &cg_backend_real;
+    }
+    if (strcmp(name, "sim") == 0) {
+        return &cg_backend_sim;
+    }
+    return NULL;
+}
@@ -0,0 +1,391 @@
+#include "cg_backend.h"
+#include "pressure_pulse.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+
+#define SIM_MAX_GROUPS 16
+#define SIM_PATH_MAX 256
+#define SIM_PAGE_SIZE 4096
+#define SIM_UNLIMITED UINT64_MAX
+
+// Kernel PSI averaging: fixed point with 11 fractional bits, updated every 2 s
+#define PSI_FREQ_NS 2000000000LL
+#define FSHIFT 11
+#define FIXED_1 (1UL << FSHIFT)
+#define EXP_10s 1677
+#define EXP_60s 1981
+#define EXP_300s 2034
+
+struct sim_group {
+    char path[SIM_PATH_MAX];
+    uint64_t memory_max;
+    // Workload hosted by this group (resident == 0: none)
+    uint64_t resident;
+    int64_t pulse_end_ns;
+    // PSI state for the subtree rooted here
+    double some_ns;
+    double full_ns;
+    double some_at_avg;
+    double full_at_avg;
+    unsigned long some_avg[3];
+    unsigned long full_avg[3];
+};
+
+static struct sim_group groups[SIM_MAX_GROUPS];
+static int ngroups;
+static struct sim_params params;
+static int64_t sim_now;
+static int64_t next_avg_ns;
+static uint64_t rng_state;
+static int configured;
+
+void sim_params_default(struct sim_params *p) {
+    p->seed = 1;
+    p->refault_ns_per_page = 4000;
+    p->pageout_ns_per_page = 1500;
+    p->noise_fraction = 0.002;
+}
+
+void sim_backend_configure(const struct sim_params *p) {
+    params = *p;
+    memset(groups, 0, sizeof(groups));
+    ngroups = 0;
+    sim_now = 0;
+    next_avg_ns = PSI_FREQ_NS;
+    rng_state = p->seed ? p->seed : 1;
+    configured = 1;
+}
+
+static void ensure_configured(void) {
+    if (!configured) {
+        struct sim_params p;
+        sim_params_default(&p);
+        sim_backend_configure(&p);
+    }
+}
+
+// xorshift64*, uniform in (0, 1]
+static double rng_uniform(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    uint64_t x = rng_state * 0x2545F4914F6CDD1DULL;
+    return ((x >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+static struct sim_group *find_group(const char *path) {
+    for (int i = 0; i < ngroups; i++) {
+        if (strcmp(groups[i].path, path) == 0) {
+            return &groups[i];
+        }
+    }
+    errno = ENOENT;
+    return NULL;
+}
+
+static uint64_t subtree_resident(const struct sim_group *root) {
+    uint64_t total = 0;
+    for (int i = 0; i < ngroups; i++) {
+        if (cg_in_subtree(groups[i].path, root->path)) {
+            total += groups[i].resident;
+        }
+    }
+    return total;
+}
+
+// Share of time a workload spends stalled while it keeps re-touching its
+// memory and the subtree it lives in does not fit under memory.max: the part
+// of its working set that has to be reclaimed and refaulted.
+static double reclaim_fraction(const struct sim_group *g) {
+    double worst = 0.0;
+    for (int i = 0; i < ngroups; i++) {
+        const struct sim_group *limit = &groups[i];
+        if (limit->memory_max == SIM_UNLIMITED || !cg_in_subtree(g->path, limit->path)) {
+            continue;
+        }
+        uint64_t demand = subtree_resident(limit);
+        if (demand > limit->memory_max) {
+            double f = (double)(demand - limit->memory_max) / (double)demand;
+            worst = f > worst ? f : worst;
+        }
+    }
+    return worst;
+}
+
+static double pulse_fraction(void) {
+    return (double)params.refault_ns_per_page /
+           (double)(params.refault_ns_per_page + params.pageout_ns_per_page);
+}
+
+static double task_stall_fraction(const struct sim_group *g) {
+    double f_pulse = sim_now < g->pulse_end_ns ? pulse_fraction() : 0.0;
+    return 1.0 - (1.0 - f_pulse) * (1.0 - reclaim_fraction(g));
+}
+
+// Kernel calc_load(): exponentially decaying average in FIXED_1 units
+static unsigned long calc_load(unsigned long load, unsigned long exp, unsigned long active) {
+    unsigned long newload = load * exp + active * (FIXED_1 - exp);
+    if (active >= load) {
+        newload += FIXED_1 - 1;
+    }
+    return newload / FIXED_1;
+}
+
+static void update_avgs(unsigned long avg[3], double stall_ns) {
+    unsigned long pct = (unsigned long)(stall_ns * 100.0 / PSI_FREQ_NS);
+    if (pct > 100) {
+        pct = 100;
+    }
+    pct *= FIXED_1;
+    avg[0] = calc_load(avg[0], EXP_10s, pct);
+    avg[1] = calc_load(avg[1], EXP_60s, pct);
+    avg[2] = calc_load(avg[2], EXP_300s, pct);
+}
+
+// Integrates one interval in which no pulse starts or ends.
+static void integrate(int64_t dt) {
+    double stall[SIM_MAX_GROUPS];
+    for (int i = 0; i < ngroups; i++) {
+        stall[i] = groups[i].resident ? task_stall_fraction(&groups[i]) : 0.0;
+    }
+
+    for (int i = 0; i < ngroups; i++) {
+        struct sim_group *g = &groups[i];
+        double none_stalled = 1.0, all_stalled = 1.0;
+        int tasks = 0;
+        for (int j = 0; j < ngroups; j++) {
+            if (groups[j].resident && cg_in_subtree(groups[j].path, g->path)) {
+                none_stalled *= 1.0 - stall[j];
+                all_stalled *= stall[j];
+                tasks++;
+            }
+        }
+        if (tasks == 0) {
+            continue;
+        }
+        // Unrelated stalls (kswapd, other tenants): exponential with the configured mean
+        double noise = -log(rng_uniform()) * params.noise_fraction * (double)dt;
+        g->some_ns += (1.0 - none_stalled) * (double)dt + noise;
+        g->full_ns += all_stalled * (double)dt;
+    }
+}
+
+static void advance_to(int64_t deadline) {
+    while (sim_now < deadline) {
+        int64_t step_end = deadline < next_avg_ns ? deadline : next_avg_ns;
+        for (int i = 0; i < ngroups; i++) {
+            if (groups[i].pulse_end_ns > sim_now && groups[i].pulse_end_ns < step_end) {
+                step_end = groups[i].pulse_end_ns;
+            }
+        }
+        integrate(step_end - sim_now);
+        sim_now = step_end;
+
+        if (sim_now == next_avg_ns) {
+            for (int i = 0; i < ngroups; i++) {
+                struct sim_group *g = &groups[i];
+                update_avgs(g->some_avg, g->some_ns - g->some_at_avg);
+                update_avgs(g->full_avg, g->full_ns - g->full_at_avg);
+                g->some_at_avg = g->some_ns;
+                g->full_at_avg = g->full_ns;
+            }
+            next_avg_ns += PSI_FREQ_NS;
+        }
+    }
+}
+
+static int parse_bytes(const char *value, uint64_t *bytes) {
+    if (strncmp(value, "max", 3) == 0) {
+        *bytes = SIM_UNLIMITED;
+        return 0;
+    }
+    char *end;
+    unsigned long long n = strtoull(value, &end, 10);
+    if (end == value) {
+        return -1;
+    }
+    switch (*end) {
+        case 'K': case 'k': n <<= 10; break;
+        case 'M': case 'm': n <<= 20; break;
+        case 'G': case 'g': n <<= 30; break;
+        default: break;
+    }
+    *bytes = n;
+    return 0;
+}
+
+static int sim_make_group(const char *path) {
+    ensure_configured();
+    if (find_group(path)) {
+        return 0;
+    }
+    if (ngroups == SIM_MAX_GROUPS || strlen(path) >= SIM_PATH_MAX) {
+        errno = ENOSPC;
+        return -1;
+    }
+    struct sim_group *g = &groups[ngroups++];
+    memset(g, 0, sizeof(*g));
+    snprintf(g->path, sizeof(g->path), "%s", path);
+    g->memory_max = SIM_UNLIMITED;
+    return 0;
+}
+
+static int sim_remove_group(const char *path) {
+    ensure_configured();
+    struct sim_group *g = find_group(path);
+    if (!g) {
+        return 0;
+    }
+    if (g->resident) {
+        errno = EBUSY;
+        return -1;
+    }
+    *g = groups[--ngroups];
+    return 0;
+}
+
+static int sim_write_knob(const char *path, const char *knob, const char *value) {
+    ensure_configured();
+    struct sim_group *g = find_group(path);
+    if (strcmp(knob, "memory.max") == 0) {
+        if (!g) {
+            return -1;
+        }
+        if (parse_bytes(value, &g->memory_max) == -1) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    // subtree_control and anything else: accepted, nothing to model
+    return 0;
+}
+
+static int sim_make_groups(const char *root, const char *memory_max, int nslots) {
+    if (sim_make_group(root) == -1 || sim_write_knob(root, "memory.max", memory_max) == -1) {
+        return -1;
+    }
+    for (int i = 0; i < nslots; i++) {
+        char path[SIM_PATH_MAX];
+        if (snprintf(path, sizeof(path), "%s/slot%d", root, i) >= (int)sizeof(path) ||
+            sim_make_group(path) == -1) {
+            errno = ENOSPC;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int sim_read_pressure(const char *path, struct psi_sample *sample) {
+    ensure_configured();
+    const struct sim_group *g = find_group(path);
+    if (!g) {
+        return -1;
+    }
+    memset(sample, 0, sizeof(*sample));
+    sample->some.total = (unsigned long long)(g->some_ns / 1000.0);
+    sample->full.total = (unsigned long long)(g->full_ns / 1000.0);
+    sample->some.avg10 = (double)g->some_avg[0] / FIXED_1;
+    sample->some.avg60 = (double)g->some_avg[1] / FIXED_1;
+    sample->some.avg300 = (double)g->some_avg[2] / FIXED_1;
+    sample->full.avg10 = (double)g->full_avg[0] / FIXED_1;
+    sample->full.avg60 = (double)g->full_avg[1] / FIXED_1;
+    sample->full.avg300 = (double)g->full_avg[2] / FIXED_1;
+    return 0;
+}
+
+static int sim_kill_group(const char *path) {
+    ensure_configured();
+    for (int i = 0; i < ngroups; i++) {
+        if (cg_in_subtree(groups[i].path, path)) {
+            groups[i].resident = 0;
+            groups[i].pulse_end_ns = 0;
+        }
+    }
+    return 0;
+}
+
+static void sim_remove_groups(const char *root) {
+    sim_kill_group(root);
+    for (int i = 0; i < ngroups;) {
+        if (cg_in_subtree(groups[i].path, root)) {
+            sim_remove_group(groups[i].path);
+        } else {
+            i++;
+        }
+    }
+}
+
+static int sim_set_load(const char *path, size_t bytes) {
+    ensure_configured();
+    struct sim_group *g = find_group(path);
+    if (!g) {
+        return -1;
+    }
+    g->resident = bytes - bytes % SIM_PAGE_SIZE;
+    return 0;
+}
+
+// Like pulse_emit(): whole chunks of PULSE_CHUNK_PAGES until width_ns is
+// reached, and no pulse shorter than one chunk.
+static int64_t sim_pulse_length_ns(const char *path, size_t amplitude, int64_t width_ns) {
+    ensure_configured();
+    const struct sim_group *g = find_group(path);
+    if (!g) {
+        return -1;
+    }
+    uint64_t pages = amplitude / SIM_PAGE_SIZE;
+    if (pages == 0 || amplitude > g->resident) {
+        errno = EINVAL;
+        return -1;
+    }
+    uint64_t chunk_pages = pages < PULSE_CHUNK_PAGES ? pages : PULSE_CHUNK_PAGES;
+    int64_t chunk_ns = (int64_t)chunk_pages *
+                       (params.refault_ns_per_page + params.pageout_ns_per_page);
+    if (width_ns < chunk_ns) {
+        errno = ERANGE;
+        return -1;
+    }
+    return (width_ns + chunk_ns - 1) / chunk_ns * chunk_ns;
+}
+
+static int sim_pulse(const char *path, size_t amplitude, int64_t width_ns) {
+    int64_t length = sim_pulse_length_ns(path, amplitude, width_ns);
+    if (length == -1) {
+        return -1;
+    }
+    struct sim_group *g = find_group(path);
+    int64_t end = sim_now + length;
+    if (end > g->pulse_end_ns) {
+        g->pulse_end_ns = end;
+    }
+    return 0;
+}
+
+static int64_t sim_now_ns(void) {
+    ensure_configured();
+    return sim_now;
+}
+
+static int sim_sleep_until(int64_t deadline_ns) {
+    ensure_configured();
+    advance_to(deadline_ns);
+    return 0;
+}
+
+const struct cg_backend cg_backend_sim = {
+    .name = "sim",
+    .make_groups = sim_make_groups,
+    .remove_groups = sim_remove_groups,
+    .write_knob = sim_write_knob,
+    .read_pressure = sim_read_pressure,
+    .kill_group = sim_kill_group,
+    .set_load = sim_set_load,
+    .pulse = sim_pulse,
+    .pulse_length_ns = sim_pulse_length_ns,
+    .now_ns = sim_now_ns,
+    .sleep_until = sim_sleep_until,
+};
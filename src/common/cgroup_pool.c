@@ -0,0 +1,317 @@
+#include "cgroup_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "rt_timing.h"
+
+int cgroup_write_knob(const char *dir, const char *knob, const char *value) {
+    char path[CGROUP_POOL_PATH_MAX + 64];
+    snprintf(path, sizeof(path), "%s/%s", dir, knob);
+
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    size_t len = strlen(value);
+    ssize_t written = write(fd, value, len);
+    int saved = errno;
+    close(fd);
+    if (written != (ssize_t)len) {
+        errno = written == -1 ? saved : EIO;
+        return -1;
+    }
+    return 0;
+}
+
+static int open_knob(const char *dir, const char *knob, int flags) {
+    char path[CGROUP_POOL_PATH_MAX + 64];
+    snprintf(path, sizeof(path), "%s/%s", dir, knob);
+    return open(path, flags | O_CLOEXEC);
+}
+
+// Returns 1 if populated, 0 if empty, -1 on read error.
+static int read_populated(int events_fd) {
+    char buf[256];
+    ssize_t n = pread(events_fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) {
+        return -1;
+    }
+    buf[n] = '\0';
+
+    const char *p = strstr(buf, "populated ");
+    if (!p) {
+        return -1;
+    }
+    return p[strlen("populated ")] != '0';
+}
+
+// cgroup.events raises POLLPRI on every change, so we sleep in poll()
+// instead of spinning on rmdir() until EBUSY goes away.
+static int wait_unpopulated(int events_fd, int timeout_ms) {
+    int64_t start = monotonic_ns();
+
+    for (;;) {
+        int populated = read_populated(events_fd);
+        if (populated == 0) {
+            return 0;
+        }
+        if (populated < 0) {
+            return -1;
+        }
+
+        long remaining = timeout_ms - (long)((monotonic_ns() - start) / 1000000);
+        if (remaining <= 0) {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+        struct pollfd pfd = {.fd = events_fd, .events = POLLPRI};
+        if (poll(&pfd, 1, (int)remaining) == -1 && errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+// Fallback for kernels without cgroup.kill: SIGKILL whatever cgroup.procs lists
+// here and in every child cgroup, since the pool root itself holds no processes.
+static int kill_listed_procs(const char *path) {
+    char procs_path[CGROUP_POOL_PATH_MAX + 64];
+    snprintf(procs_path, sizeof(procs_path), "%s/cgroup.procs", path);
+
+    FILE *fp = fopen(procs_path, "re");
+    if (!fp) {
+        return -1;
+    }
+    int pid;
+    while (fscanf(fp, "%d", &pid) == 1) {
+        kill(pid, SIGKILL);
+    }
+    fclose(fp);
+
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return -1;
+    }
+    int ret = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_type != DT_DIR || entry->d_name[0] == '.') {
+            continue;
+        }
+        char child[CGROUP_POOL_PATH_MAX];
+        if (snprintf(child, sizeof(child), "%s/%s", path, entry->d_name) >= (int)sizeof(child) ||
+            kill_listed_procs(child) == -1) {
+            ret = -1;
+        }
+    }
+    closedir(dir);
+    return ret;
+}
+
+static int kill_cgroup(const char *path) {
+    if (cgroup_write_knob(path, "cgroup.kill", "1\n") == 0) {
+        return 0;
+    }
+    if (errno != ENOENT) {
+        return -1;
+    }
+    return kill_listed_procs(path);
+}
+
+int cgroup_kill_and_wait(const char *path, int timeout_ms) {
+    int events_fd = open_knob(path, "cgroup.events", O_RDONLY);
+    if (events_fd == -1) {
+        return -1;
+    }
+
+    int ret = kill_cgroup(path);
+    if (ret == 0) {
+        ret = wait_unpopulated(events_fd, timeout_ms);
+    }
+    int saved = errno;
+    close(events_fd);
+    errno = saved;
+    return ret;
+}
+
+static int enable_memory_controller(const char *dir) {
+    if (cgroup_write_knob(dir, "cgroup.subtree_control", "+memory\n") == -1) {
+        fprintf(stderr, "Failed to enable memory controller in %s: %s\n",
+                dir, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int open_slot(struct cgroup_slot *slot) {
+    slot->procs_fd = open_knob(slot->path, "cgroup.procs", O_WRONLY);
+    slot->events_fd = open_knob(slot->path, "cgroup.events", O_RDONLY);
+    if (slot->procs_fd == -1 || slot->events_fd == -1) {
+        fprintf(stderr, "Failed to open control files of %s: %s\n",
+                slot->path, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+int cgroup_pool_init(struct cgroup_pool *pool, const char *root,
+                     const char *root_memory_max, const char *slot_memory_max,
+                     int nslots) {
+    if (nslots < 1 || nslots > CGROUP_POOL_MAX_SLOTS ||
+        strlen(root) + 16 >= CGROUP_POOL_PATH_MAX) {
+        errno = EINVAL;
+        perror("cgroup pool configuration");
+        return -1;
+    }
+
+    memset(pool, 0, sizeof(*pool));
+    snprintf(pool->root, sizeof(pool->root), "%s", root);
+    pool->slot_memory_max = slot_memory_max;
+    pool->nslots = nslots;
+    for (int i = 0; i < CGROUP_POOL_MAX_SLOTS; i++) {
+        pool->slots[i].procs_fd = -1;
+        pool->slots[i].events_fd = -1;
+    }
+
+    // The parent has to delegate the memory controller before we can set memory.max.
+    char parent[CGROUP_POOL_PATH_MAX];
+    snprintf(parent, sizeof(parent), "%s", root);
+    char *slash = strrchr(parent, '/');
+    if (slash && slash != parent) {
+        *slash = '\0';
+    }
+    if (enable_memory_controller(parent) == -1) {
+        return -1;
+    }
+
+    if (mkdir(pool->root, 0755) == -1 && errno != EEXIST) {
+        perror("cgroup creation failed");
+        return -1;
+    }
+    // A crashed earlier run may have left processes behind; no-internal-process
+    // rule also requires the root to be empty before delegating further.
+    if (cgroup_kill_and_wait(pool->root, CGROUP_POOL_KILL_TIMEOUT_MS) == -1) {
+        perror("Failed to empty cgroup");
+        return -1;
+    }
+    if (root_memory_max && cgroup_write_knob(pool->root, "memory.max", root_memory_max) == -1) {
+        perror("Failed to set memory limit");
+        return -1;
+    }
+    if (enable_memory_controller(pool->root) == -1) {
+        return -1;
+    }
+
+    for (int i = 0; i < nslots; i++) {
+        struct cgroup_slot *slot = &pool->slots[i];
+        snprintf(slot->path, sizeof(slot->path), "%s/slot%d", pool->root, i);
+        if (mkdir(slot->path, 0755) == -1 && errno != EEXIST) {
+            perror("cgroup slot creation failed");
+            cgroup_pool_destroy(pool);
+            return -1;
+        }
+        if (open_slot(slot) == -1 || cgroup_pool_reset(pool, slot) == -1) {
+            cgroup_pool_destroy(pool);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+struct cgroup_slot *cgroup_pool_acquire(struct cgroup_pool *pool) {
+    for (int i = 0; i < pool->nslots; i++) {
+        if (!pool->slots[i].in_use) {
+            pool->slots[i].in_use = 1;
+            return &pool->slots[i];
+        }
+    }
+    return NULL;
+}
+
+int cgroup_pool_attach_self(const struct cgroup_slot *slot) {
+    // "0" means the writing process.
+    ssize_t written = write(slot->procs_fd, "0\n", 2);
+    return written == 2 ? 0 : -1;
+}
+
+int cgroup_pool_reset(struct cgroup_pool *pool, struct cgroup_slot *slot) {
+    if (kill_cgroup(slot->path) == -1) {
+        fprintf(stderr, "Failed to kill %s: %s\n", slot->path, strerror(errno));
+        return -1;
+    }
+    if (wait_unpopulated(slot->events_fd, CGROUP_POOL_KILL_TIMEOUT_MS) == -1) {
+        fprintf(stderr, "%s did not drain: %s\n", slot->path, strerror(errno));
+        return -1;
+    }
+    if (pool->slot_memory_max &&
+        cgroup_write_knob(slot->path, "memory.max", pool->slot_memory_max) == -1) {
+        fprintf(stderr, "Failed to restore memory.max of %s: %s\n",
+                slot->path, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+void cgroup_pool_close(struct cgroup_pool *pool) {
+    if (pool->root[0] == '\0') {
+        return;
+    }
+    if (cgroup_kill_and_wait(pool->root, CGROUP_POOL_KILL_TIMEOUT_MS) == -1 &&
+        errno != ENOENT) {
+        fprintf(stderr, "Failed to drain %s: %s\n", pool->root, strerror(errno));
+    }
+
+    for (int i = 0; i < pool->nslots; i++) {
+        struct cgroup_slot *slot = &pool->slots[i];
+        if (slot->procs_fd != -1) {
+            close(slot->procs_fd);
+        }
+        if (slot->events_fd != -1) {
+            close(slot->events_fd);
+        }
+        slot->procs_fd = slot->events_fd = -1;
+        slot->in_use = 0;
+    }
+}
+
+static void remove_dirs(const char *root, int nslots) {
+    char path[CGROUP_POOL_PATH_MAX];
+    for (int i = 0; i < nslots; i++) {
+        snprintf(path, sizeof(path), "%s/slot%d", root, i);
+        if (rmdir(path) == -1 && errno != ENOENT) {
+            fprintf(stderr, "Failed to remove %s: %s\n", path, strerror(errno));
+        }
+    }
+
+    if (rmdir(root) == -1 && errno != ENOENT) {
+        fprintf(stderr, "Failed to clean up cgroup %s: %s\n", root, strerror(errno));
+    }
+}
+
+void cgroup_pool_destroy(struct cgroup_pool *pool) {
+    if (pool->root[0] == '\0') {
+        return;
+    }
+    cgroup_pool_close(pool);
+    remove_dirs(pool->root, pool->nslots);
+    pool->root[0] = '\0';
+}
+
+void cgroup_pool_remove(const char *root, int nslots) {
+    // A root that was never created or is already gone is not an error
+    if (cgroup_kill_and_wait(root, CGROUP_POOL_KILL_TIMEOUT_MS) == -1) {
+        if (errno == ENOENT) {
+            return;
+        }
+        fprintf(stderr, "Failed to drain %s: %s\n", root, strerror(errno));
+    }
+    remove_dirs(root, nslots);
+}
@@ -0,0 +1,102 @@
+/*
+ * Pre-warmed pool of memory cgroups.
+ *
+ * Creating a cgroup, enabling +memory on the parent's subtree_control and
+ * writing memory.max costs several filesystem round trips per run, and the
+ * old per-PID SIGTERM/waitpid teardown followed by rmdir() regularly failed
+ * with EBUSY while stress-ng children were still exiting. The pool creates
+ * and configures all slots once, hands them out, and resets a slot by killing
+ * everything in it at once through cgroup.kill, waiting for cgroup.events to
+ * report populated 0 and restoring the configured knobs.
+ *
+ * Layout: <root>/slot0 .. <root>/slot<N-1>. PSI is hierarchical, so a
+ * receiver watching <root>/memory.pressure still sees every slot.
+ *
+ * cgroup_pool_close() empties the slots but leaves the directories in place,
+ * so the next run's cgroup_pool_init() on the same root finds them (EEXIST)
+ * and only saves the mkdir of each memory cgroup; subtree_control and
+ * memory.max are still rewritten and every slot is reset.
+ * cgroup_pool_destroy() removes them for good, cgroup_pool_remove() does the
+ * same for a pool that this process never opened.
+ */
+#ifndef PSICOVERT_CGROUP_POOL_H
+#define PSICOVERT_CGROUP_POOL_H
+
+#define CGROUP_POOL_MAX_SLOTS 32
+#define CGROUP_POOL_PATH_MAX 256
+#define CGROUP_POOL_KILL_TIMEOUT_MS 5000
+
+struct cgroup_slot {
+    char path[CGROUP_POOL_PATH_MAX];
+    int procs_fd;   // pre-opened cgroup.procs (O_CLOEXEC), for cheap attach
+    int events_fd;  // cgroup.events, polled for populated 0
+    int in_use;
+};
+
+struct cgroup_pool {
+    char root[CGROUP_POOL_PATH_MAX];
+    const char *slot_memory_max;  // restored on every reset
+    int nslots;
+    struct cgroup_slot slots[CGROUP_POOL_MAX_SLOTS];
+};
+
+/**
+ * Creates <root> with memory.max = root_memory_max, enables the memory
+ * controller for its children and pre-creates nslots slots, each configured
+ * with memory.max = slot_memory_max. Leftovers from an earlier run are
+ * killed. Returns 0 on success, -1 on failure (errno set, message printed).
+ */
+int cgroup_pool_init(struct cgroup_pool *pool, const char *root,
+                     const char *root_memory_max, const char *slot_memory_max,
+                     int nslots);
+
+/**
+ * Returns a free slot, or NULL if every slot is handed out.
+ */
+struct cgroup_slot *cgroup_pool_acquire(struct cgroup_pool *pool);
+
+/**
+ * Moves the calling process into the slot. Meant to be called in a forked
+ * child before exec, so the workload never runs outside the cgroup.
+ */
+int cgroup_pool_attach_self(const struct cgroup_slot *slot);
+
+/**
+ * Kills every process in the slot, waits until it is empty and restores its
+ * knobs. The slot stays handed out.
+ */
+int cgroup_pool_reset(struct cgroup_pool *pool, struct cgroup_slot *slot);
+
+/**
+ * Kills everything in the pool and closes its control files, keeping the
+ * cgroups for the next run.
+ */
+void cgroup_pool_close(struct cgroup_pool *pool);
+
+/**
+ * Closes the pool and removes all slots and the root.
+ */
+void cgroup_pool_destroy(struct cgroup_pool *pool);
+
+/**
+ * Removes the slots and root a previous run left at root without setting
+ * anything up: kills what is still running there and rmdirs <root>/slot0 ..
+ * <root>/slot<nslots-1> and root. Does nothing if root does not exist.
+ */
+void cgroup_pool_remove(const char *root, int nslots);
+
+/**
+ * Writes value to <dir>/<knob>. Returns 0, or -1 with errno set (EIO for a
+ * short write).
+ */
+int cgroup_write_knob(const char *dir, const char *knob, const char *value);
+
+/**
+ * Kills all processes in the cgroup at path and its descendants (cgroup.kill,
+ * or SIGKILL per PID from every cgroup.procs in the subtree on kernels older
+ * than 5.14) and waits up to timeout_ms for
+ * cgroup.events to report populated 0.
+ */
+int cgroup_kill_and_wait(const char *path, int timeout_ms);
+
+#endif
@@ -0,0 +1,141 @@
+#include "pressure_pulse.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include "rt_timing.h"
+
+#ifndef MADV_PAGEOUT
+#define MADV_PAGEOUT 21  // Linux 5.4+, missing from older libc headers
+#endif
+
+static long elapsed_us(int64_t start_ns) {
+    return (long)((monotonic_ns() - start_ns) / 1000);
+}
+
+static void touch_pages(char *start, size_t len, size_t page_size) {
+    for (size_t off = 0; off < len; off += page_size) {
+        ((volatile char *)start)[off]++;
+    }
+}
+
+static int page_cycle(char *start, size_t len, size_t page_size) {
+    if (madvise(start, len, MADV_PAGEOUT) == -1) {
+        return -1;
+    }
+    touch_pages(start, len, page_size);
+    return 0;
+}
+
+int pulse_worker_init(struct pulse_worker *worker, size_t size) {
+    memset(worker, 0, sizeof(*worker));
+    worker->page_size = (size_t)sysconf(_SC_PAGESIZE);
+    worker->size = size - size % worker->page_size;
+    if (worker->size == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    void *buf = mmap(NULL, worker->size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf == MAP_FAILED) {
+        return -1;
+    }
+    // Huge pages would make every slice a 2 MiB swap-out, so stay at base pages.
+    madvise(buf, worker->size, MADV_NOHUGEPAGE);
+    worker->buf = buf;
+
+    // Non-zero writes, so pages are real anon pages and not the shared zero page.
+    touch_pages(worker->buf, worker->size, worker->page_size);
+
+    size_t chunk = PULSE_CHUNK_PAGES * worker->page_size;
+    if (chunk > worker->size) {
+        chunk = worker->size;
+    }
+    for (int i = 0; i < PULSE_CALIBRATION_CHUNKS; i++) {
+        int64_t start = monotonic_ns();
+        if (page_cycle(worker->buf, chunk, worker->page_size) == -1) {
+            pulse_worker_destroy(worker);
+            return -1;
+        }
+        long us = elapsed_us(start);
+        if (us > worker->chunk_us) {
+            worker->chunk_us = us;
+        }
+    }
+    return 0;
+}
+
+long pulse_emit(struct pulse_worker *worker, size_t amplitude, long width_us) {
+    amplitude -= amplitude % worker->page_size;
+    if (amplitude == 0 || amplitude > worker->size) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (width_us < worker->chunk_us) {
+        errno = ERANGE;
+        return -1;
+    }
+
+    if (worker->cursor + amplitude > worker->size) {
+        worker->cursor = 0;
+    }
+    char *slice = worker->buf + worker->cursor;
+    size_t chunk = PULSE_CHUNK_PAGES * worker->page_size;
+
+    int64_t start = monotonic_ns();
+
+    size_t off = 0;
+    long elapsed;
+    do {
+        size_t len = amplitude - off < chunk ? amplitude - off : chunk;
+        if (page_cycle(slice + off, len, worker->page_size) == -1) {
+            return -1;
+        }
+        off = off + len == amplitude ? 0 : off + len;
+        elapsed = elapsed_us(start);
+    } while (elapsed < width_us);
+
+    worker->cursor += amplitude;
+    return elapsed;
+}
+
+void pulse_worker_destroy(struct pulse_worker *worker) {
+    if (worker->buf) {
+        munmap(worker->buf, worker->size);
+        worker->buf = NULL;
+    }
+}
+
+void pulse_worker_serve(size_t size, int cmd_fd, int reply_fd) {
+    struct pulse_worker worker;
+    if (pulse_worker_init(&worker, size) == -1) {
+        perror("Failed to map pulse buffer");
+        _exit(EXIT_FAILURE);
+    }
+    if (reply_fd != -1 && write(reply_fd, &worker.chunk_us, sizeof(long)) != sizeof(long)) {
+        _exit(EXIT_FAILURE);
+    }
+
+    struct pulse_cmd cmd;
+    while (read(cmd_fd, &cmd, sizeof(cmd)) == sizeof(cmd)) {
+        long width_us = pulse_emit(&worker, cmd.amplitude, cmd.width_us);
+        if (width_us == -1 && !cmd.reply) {
+            perror("Failed to emit pulse");
+            _exit(EXIT_FAILURE);
+        }
+        if (cmd.reply) {
+            width_us = width_us == -1 ? -errno : width_us;
+            if (reply_fd == -1 || write(reply_fd, &width_us, sizeof(width_us)) != sizeof(width_us)) {
+                break;
+            }
+        }
+    }
+    pulse_worker_destroy(&worker);
+    _exit(EXIT_SUCCESS);
+}
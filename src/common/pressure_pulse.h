@@ -0,0 +1,69 @@
+/*
+ * Short, precisely sized memory-pressure pulses from one resident buffer.
+ *
+ * Starting a fresh stress-ng that allocates and frees 1 GiB per symbol spends
+ * most of the symbol time on setup. A pulse worker instead keeps one buffer
+ * resident and, to emit a pulse, pages out a slice of it with
+ * madvise(MADV_PAGEOUT) and immediately re-touches it. The refaults stall the
+ * worker in the kernel for a duration set by the pulse width, and the stall
+ * shows up in the cgroup's memory.pressure.
+ *
+ * The slice is worked through in chunks of PULSE_CHUNK_PAGES pages and the
+ * deadline is checked between chunks, so a pulse overruns its width by at
+ * most one chunk, whatever the amplitude. The chunk cost is measured once
+ * when the worker starts; widths shorter than one chunk are rejected.
+ *
+ * Anonymous pages can only be paged out to swap, so the host needs swap or
+ * zram; without it MADV_PAGEOUT is a no-op and pulses carry no pressure.
+ * MADV_COLD is not used: it only deactivates pages and produces no stall by
+ * itself.
+ */
+#ifndef PSICOVERT_PRESSURE_PULSE_H
+#define PSICOVERT_PRESSURE_PULSE_H
+
+#include <stddef.h>
+
+#define PULSE_CHUNK_PAGES 64
+#define PULSE_CALIBRATION_CHUNKS 4
+
+struct pulse_worker {
+    char *buf;
+    size_t size;
+    size_t page_size;
+    size_t cursor;   // next slice to page out, so pulses rotate through the buffer
+    long chunk_us;   // slowest of the calibration chunks; shortest accepted width
+};
+
+// Command a controller sends to a worker running pulse_worker_serve()
+struct pulse_cmd {
+    size_t amplitude;
+    long width_us;
+    int reply;  // write the measured width (or -errno) back after the pulse
+};
+
+/**
+ * Maps and faults in a buffer of size bytes and measures the cost of one
+ * page-out/refault chunk. Returns 0 or -1.
+ */
+int pulse_worker_init(struct pulse_worker *worker, size_t size);
+
+/**
+ * Emits one pulse: pages out and re-touches the next amplitude bytes chunk by
+ * chunk, wrapping around inside the slice, until width_us has elapsed.
+ * Returns the measured pulse length in microseconds, or -1 on error (errno
+ * ERANGE if width_us is shorter than one chunk).
+ */
+long pulse_emit(struct pulse_worker *worker, size_t amplitude, long width_us);
+
+void pulse_worker_destroy(struct pulse_worker *worker);
+
+/**
+ * Body of a forked pulse worker that has already joined its cgroup: keeps a
+ * size-byte buffer resident and emits one pulse per struct pulse_cmd read
+ * from cmd_fd until it is closed. If reply_fd is not -1 the calibrated
+ * chunk_us is written to it once the buffer is resident. A failed pulse that
+ * was not asked for a reply ends the worker. Never returns.
+ */
+void pulse_worker_serve(size_t size, int cmd_fd, int reply_fd) __attribute__((noreturn));
+
+#endif
@@ -0,0 +1,47 @@
+#include "psi.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+int psi_open(const char *path) {
+    return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+static int parse_line(const char *buf, const char *tag, struct psi_line *line) {
+    const char *p = strstr(buf, tag);
+    if (!p) {
+        return -1;
+    }
+    int n = sscanf(p + strlen(tag), " avg10=%lf avg60=%lf avg300=%lf total=%llu",
+                   &line->avg10, &line->avg60, &line->avg300, &line->total);
+    return n == 4 ? 0 : -1;
+}
+
+int psi_read_fd(int fd, struct psi_sample *sample) {
+    char buf[256];
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) {
+        return -1;
+    }
+    buf[n] = '\0';
+
+    memset(sample, 0, sizeof(*sample));
+    if (parse_line(buf, "some", &sample->some) == -1) {
+        return -1;
+    }
+    // The system-wide cpu.pressure has no "full" line on older kernels.
+    parse_line(buf, "full", &sample->full);
+    return 0;
+}
+
+int psi_read(const char *path, struct psi_sample *sample) {
+    int fd = psi_open(path);
+    if (fd == -1) {
+        return -1;
+    }
+    int ret = psi_read_fd(fd, sample);
+    close(fd);
+    return ret;
+}
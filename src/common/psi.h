@@ -0,0 +1,37 @@
+/*
+ * Reader for PSI pressure files (/proc/pressure/memory or a cgroup's
+ * memory.pressure). Keeping the file open and re-reading it with pread()
+ * is what makes per-symbol sampling cheap.
+ */
+#ifndef PSICOVERT_PSI_H
+#define PSICOVERT_PSI_H
+
+struct psi_line {
+    double avg10;
+    double avg60;
+    double avg300;
+    unsigned long long total;  // cumulative stall time in microseconds
+};
+
+struct psi_sample {
+    struct psi_line some;
+    struct psi_line full;
+};
+
+/**
+ * Opens a pressure file for repeated sampling. Returns an fd or -1.
+ */
+int psi_open(const char *path);
+
+/**
+ * Parses the current contents of an fd returned by psi_open().
+ * Returns 0 on success, -1 on read or parse error.
+ */
+int psi_read_fd(int fd, struct psi_sample *sample);
+
+/**
+ * One-shot variant of psi_open() + psi_read_fd().
+ */
+int psi_read(const char *path, struct psi_sample *sample);
+
+#endif
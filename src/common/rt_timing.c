@@ -0,0 +1,227 @@
+#define _GNU_SOURCE
+#include "rt_timing.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
+#define RT_DEADLINE_MAX_RUNTIME_NS 2000000L  // budget per period for the controller
+
+// glibc has no wrapper for sched_setattr
+struct rt_sched_attr {
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+};
+
+void rt_options_init(struct rt_options *opts) {
+    opts->enabled = 0;
+    opts->cpu = -1;
+    opts->deadline = 0;
+    opts->priority = RT_DEFAULT_PRIORITY;
+}
+
+int rt_parse_option(const char *arg, struct rt_options *opts) {
+    char *endptr;
+    if (strcmp(arg, "--rt") == 0) {
+        opts->enabled = 1;
+    } else if (strcmp(arg, "--rt-deadline") == 0) {
+        opts->enabled = opts->deadline = 1;
+    } else if (strncmp(arg, "--rt-cpu=", 9) == 0) {
+        long cpu = strtol(arg + 9, &endptr, 10);
+        if (*endptr || arg[9] == '\0' || cpu < 0 || cpu >= CPU_SETSIZE) {
+            return -1;
+        }
+        opts->enabled = 1;
+        opts->cpu = (int)cpu;
+    } else if (strncmp(arg, "--rt-prio=", 10) == 0) {
+        long prio = strtol(arg + 10, &endptr, 10);
+        if (*endptr || arg[10] == '\0' || prio < 1 || prio > 99) {
+            return -1;
+        }
+        opts->enabled = 1;
+        opts->priority = (int)prio;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+int rt_enter(const struct rt_options *opts, int64_t period_ns) {
+    if (!opts->enabled) {
+        return 0;
+    }
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == -1) {
+        perror("mlockall failed");
+        return -1;
+    }
+
+    if (opts->deadline) {
+        struct rt_sched_attr attr = {
+            .size = sizeof(attr),
+            .sched_policy = SCHED_DEADLINE,
+            .sched_runtime = period_ns / 2 < RT_DEADLINE_MAX_RUNTIME_NS
+                             ? (uint64_t)period_ns / 2 : RT_DEADLINE_MAX_RUNTIME_NS,
+            .sched_deadline = (uint64_t)period_ns,
+            .sched_period = (uint64_t)period_ns,
+        };
+        if (syscall(SYS_sched_setattr, 0, &attr, 0) == -1) {
+            perror("SCHED_DEADLINE failed");
+            return -1;
+        }
+        return 0;
+    }
+
+    if (opts->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(opts->cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) == -1) {
+            perror("CPU pinning failed");
+            return -1;
+        }
+    }
+
+    struct sched_param param = {.sched_priority = opts->priority};
+    if (sched_setscheduler(0, SCHED_FIFO, &param) == -1) {
+        perror("SCHED_FIFO failed");
+        return -1;
+    }
+    return 0;
+}
+
+int rt_keep_off_cpu(const struct rt_options *opts, pid_t pid) {
+    if (!opts->enabled) {
+        return 0;
+    }
+    if (pid == 0) {
+        munlockall();
+        struct sched_param param = {.sched_priority = 0};
+        sched_setscheduler(0, SCHED_OTHER, &param);
+    }
+    if (opts->cpu < 0) {
+        return 0;
+    }
+
+    cpu_set_t set;
+    if (sched_getaffinity(pid, sizeof(set), &set) == -1) {
+        return -1;
+    }
+    CPU_CLR(opts->cpu, &set);
+    if (CPU_COUNT(&set) == 0) {
+        return 0;  // single-CPU machine, nowhere else to go
+    }
+    return sched_setaffinity(pid, sizeof(set), &set);
+}
+
+int64_t monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+int symbol_clock_start(struct symbol_clock *clock, int64_t period_ns) {
+    memset(clock, 0, sizeof(*clock));
+    clock->jitter.min_ns = INT64_MAX;
+    clock->period_ns = period_ns;
+
+    clock->tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (clock->tfd == -1) {
+        return -1;
+    }
+
+    // Absolute start plus a fixed interval: the kernel keeps the grid, so a
+    // late wake-up never shifts the following deadlines.
+    clock->start_ns = monotonic_ns();
+    int64_t first = clock->start_ns + period_ns;
+    struct itimerspec spec = {
+        .it_interval = {.tv_sec = period_ns / 1000000000LL, .tv_nsec = period_ns % 1000000000LL},
+        .it_value = {.tv_sec = first / 1000000000LL, .tv_nsec = first % 1000000000LL},
+    };
+    if (timerfd_settime(clock->tfd, TFD_TIMER_ABSTIME, &spec, NULL) == -1) {
+        close(clock->tfd);
+        clock->tfd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+int64_t symbol_clock_wait(struct symbol_clock *clock) {
+    uint64_t expirations;
+    if (read(clock->tfd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return -1;
+    }
+    int64_t now = monotonic_ns();
+
+    clock->ticks += (long)expirations;
+    int64_t deadline = clock->start_ns + clock->ticks * clock->period_ns;
+    int64_t late = now - deadline;
+    if (late < 0) {
+        late = 0;
+    }
+
+    struct jitter_stats *j = &clock->jitter;
+    j->count++;
+    j->missed += (long)expirations - 1;
+    j->sum_ns += (double)late;
+    if (late < j->min_ns) {
+        j->min_ns = late;
+    }
+    if (late > j->max_ns) {
+        j->max_ns = late;
+    }
+    int64_t bucket = late / 1000;
+    j->hist[bucket < JITTER_BUCKETS ? bucket : JITTER_BUCKETS]++;
+    return deadline;
+}
+
+void symbol_clock_stop(struct symbol_clock *clock) {
+    if (clock->tfd != -1) {
+        close(clock->tfd);
+        clock->tfd = -1;
+    }
+}
+
+static double percentile_us(const struct jitter_stats *j, double p) {
+    unsigned long rank = (unsigned long)(p * (double)j->count);
+    unsigned long seen = 0;
+    for (int b = 0; b <= JITTER_BUCKETS; b++) {
+        seen += j->hist[b];
+        if (seen > rank) {
+            return b < JITTER_BUCKETS ? b + 1 : j->max_ns / 1000.0;  // bucket upper edge
+        }
+    }
+    return j->max_ns / 1000.0;
+}
+
+void symbol_clock_report(const struct symbol_clock *clock, FILE *out, const char *label) {
+    const struct jitter_stats *j = &clock->jitter;
+    if (j->count == 0) {
+        fprintf(out, "%s: no symbols timed\n", label);
+        return;
+    }
+    fprintf(out, "%s: %ld symbols, %ld missed, wake-up lateness (us): "
+                 "min %.1f mean %.1f p50 <%.0f p90 <%.0f p99 <%.0f p99.9 <%.0f max %.1f\n",
+            label, j->count, j->missed, j->min_ns / 1000.0, j->sum_ns / j->count / 1000.0,
+            percentile_us(j, 0.50), percentile_us(j, 0.90), percentile_us(j, 0.99),
+            percentile_us(j, 0.999), j->max_ns / 1000.0);
+    fprintf(out, "%s: worst case uses %.2f%% of the %.1f ms symbol period\n",
+            label, 100.0 * (double)j->max_ns / (double)clock->period_ns,
+            clock->period_ns / 1e6);
+}
@@ -0,0 +1,95 @@
+/*
+ * Opt-in low-jitter timing for the sender and receiver control threads.
+ *
+ * Symbols are clocked by a timerfd armed on absolute CLOCK_MONOTONIC
+ * deadlines, so lateness never accumulates from one symbol to the next.
+ * With --rt the control thread additionally locks its memory (it must not
+ * take page faults while the pressure workers are thrashing), runs under
+ * SCHED_FIFO or SCHED_DEADLINE and can be pinned to a CPU the pressure
+ * workers are kept off. Every wake-up is recorded so the lateness
+ * distribution shows how much of the symbol period is really needed as
+ * guard time.
+ *
+ * Recognised options: --rt, --rt-cpu=<n>, --rt-deadline, --rt-prio=<1-99>.
+ * SCHED_DEADLINE tasks may not have a restricted affinity, so --rt-deadline
+ * ignores --rt-cpu for the controller (workers are still kept off that CPU).
+ */
+#ifndef PSICOVERT_RT_TIMING_H
+#define PSICOVERT_RT_TIMING_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#define RT_DEFAULT_PRIORITY 80
+#define JITTER_BUCKETS 1000  // 1 us wide; one extra bucket collects overflow
+
+struct rt_options {
+    int enabled;
+    int cpu;        // -1: no pinning
+    int deadline;   // SCHED_DEADLINE instead of SCHED_FIFO
+    int priority;
+};
+
+struct jitter_stats {
+    long count;
+    long missed;    // timer expirations beyond the first, i.e. skipped symbols
+    int64_t min_ns;
+    int64_t max_ns;
+    double sum_ns;
+    unsigned long hist[JITTER_BUCKETS + 1];
+};
+
+struct symbol_clock {
+    int tfd;
+    int64_t start_ns;
+    int64_t period_ns;
+    long ticks;
+    struct jitter_stats jitter;
+};
+
+void rt_options_init(struct rt_options *opts);
+
+/**
+ * Consumes one command-line argument if it is an --rt option.
+ * Returns 1 if consumed, 0 if not an --rt option, -1 if malformed.
+ */
+int rt_parse_option(const char *arg, struct rt_options *opts);
+
+/**
+ * Applies mlockall, CPU pinning and the real-time policy to the calling
+ * thread. No-op unless opts->enabled. Returns 0 or -1 (message printed).
+ */
+int rt_enter(const struct rt_options *opts, int64_t period_ns);
+
+/**
+ * Restricts pid (0 = caller) to every online CPU except opts->cpu, so
+ * pressure workers never compete with the controller. Also drops any
+ * memory lock and real-time policy inherited from the controller.
+ */
+int rt_keep_off_cpu(const struct rt_options *opts, pid_t pid);
+
+/**
+ * CLOCK_MONOTONIC in nanoseconds, the clock used by traces and BPF.
+ */
+int64_t monotonic_ns(void);
+
+/**
+ * Arms the symbol clock; the first tick is one period from now.
+ */
+int symbol_clock_start(struct symbol_clock *clock, int64_t period_ns);
+
+/**
+ * Blocks until the next symbol boundary and records the wake-up lateness.
+ * Returns the deadline that was waited for, or -1 on error.
+ */
+int64_t symbol_clock_wait(struct symbol_clock *clock);
+
+void symbol_clock_stop(struct symbol_clock *clock);
+
+/**
+ * Prints count, min/mean/percentiles/max lateness and missed symbols.
+ */
+void symbol_clock_report(const struct symbol_clock *clock, FILE *out, const char *label);
+
+#endif
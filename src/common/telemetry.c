@@ -0,0 +1,313 @@
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "rt_timing.h"
+
+static struct telemetry_ring *map_ring(const char *name) {
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 ||
+        (st.st_size < (off_t)sizeof(struct telemetry_ring) &&
+         ftruncate(fd, sizeof(struct telemetry_ring)) == -1)) {
+        close(fd);
+        return NULL;
+    }
+    void *mem = mmap(NULL, sizeof(struct telemetry_ring), PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        return NULL;
+    }
+
+    // ftruncate zero-fills; the first publisher stamps the header.
+    struct telemetry_ring *ring = mem;
+    uint32_t expected = 0;
+    if (atomic_compare_exchange_strong(&ring->magic, &expected, TELEMETRY_MAGIC)) {
+        ring->version = TELEMETRY_VERSION;
+        ring->slots = TELEMETRY_SLOTS;
+    } else if (expected != TELEMETRY_MAGIC) {
+        munmap(mem, sizeof(struct telemetry_ring));
+        return NULL;
+    }
+    return ring;
+}
+
+static void publish(struct telemetry *telemetry, struct telemetry_record *rec) {
+    struct telemetry_ring *ring = telemetry->ring;
+    uint64_t index = atomic_fetch_add(&ring->head, 1);
+    struct telemetry_record *slot = &ring->records[index & (TELEMETRY_SLOTS - 1)];
+
+    uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    uint32_t odd = (seq + 1) | 1;
+    atomic_store_explicit(&slot->seq, odd, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    rec->index = index;
+    // Copy everything after seq; seq itself is only touched atomically.
+    size_t skip = sizeof(slot->seq);
+    memcpy((char *)slot + skip, (const char *)rec + skip, sizeof(*rec) - skip);
+
+    atomic_store_explicit(&slot->seq, odd + 1, memory_order_release);
+}
+
+static uint64_t rss_kb(pid_t pid) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/statm", pid);
+    FILE *fp = fopen(path, "re");
+    if (!fp) {
+        return 0;
+    }
+    unsigned long size = 0, resident = 0;
+    int n = fscanf(fp, "%lu %lu", &size, &resident);
+    fclose(fp);
+    return n == 2 ? resident * (uint64_t)(sysconf(_SC_PAGESIZE) / 1024) : 0;
+}
+
+static void add_stressor(struct telemetry_record *rec, pid_t pid) {
+    if (rec->nstressors < TELEMETRY_MAX_STRESSORS) {
+        rec->stressor_pid[rec->nstressors] = pid;
+        rec->stressor_rss_kb[rec->nstressors] = rss_kb(pid);
+        rec->nstressors++;
+    }
+}
+
+// Adds the leaf descendants of pid and returns whether it had any children.
+// stress-ng's parent only supervises; the memory sits in its workers' children.
+static int add_descendants(struct telemetry_record *rec, pid_t pid) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/task/%d/children", pid, pid);
+    FILE *fp = fopen(path, "re");
+    if (!fp) {
+        return 0;
+    }
+    int child, found = 0;
+    while (fscanf(fp, "%d", &child) == 1) {
+        found = 1;
+        if (!add_descendants(rec, child)) {
+            add_stressor(rec, child);
+        }
+    }
+    fclose(fp);
+    return found;
+}
+
+static void add_cgroup_procs(struct telemetry_record *rec, const char *dir) {
+    char path[TELEMETRY_PATH_LEN + 300];
+    snprintf(path, sizeof(path), "%s/cgroup.procs", dir);
+    FILE *fp = fopen(path, "re");
+    if (!fp) {
+        return;
+    }
+    int pid;
+    while (fscanf(fp, "%d", &pid) == 1) {
+        add_stressor(rec, pid);
+    }
+    fclose(fp);
+}
+
+// Pooled cgroups keep their processes one level down, so look at the
+// children as well as the cgroup itself.
+static void collect_stressors(struct telemetry *telemetry, struct telemetry_record *rec) {
+    for (int i = 0; i < telemetry->nextra_pids; i++) {
+        if (!add_descendants(rec, telemetry->extra_pids[i])) {
+            add_stressor(rec, telemetry->extra_pids[i]);
+        }
+    }
+    if (telemetry->cgroup_path[0] == '\0') {
+        return;
+    }
+    add_cgroup_procs(rec, telemetry->cgroup_path);
+
+    DIR *dir = opendir(telemetry->cgroup_path);
+    if (!dir) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_type == DT_DIR && entry->d_name[0] != '.') {
+            char child[TELEMETRY_PATH_LEN + 260];
+            snprintf(child, sizeof(child), "%s/%s", telemetry->cgroup_path, entry->d_name);
+            add_cgroup_procs(rec, child);
+        }
+    }
+    closedir(dir);
+}
+
+static void fill_record(struct telemetry *telemetry, struct telemetry_record *rec,
+                        enum telemetry_kind kind, int psi_fd) {
+    memset(rec, 0, sizeof(*rec));
+    rec->kind = kind;
+    rec->t_ns = monotonic_ns();
+    rec->pid = telemetry->pid;
+    memcpy(rec->role, telemetry->role, sizeof(rec->role));
+
+    struct psi_sample sample;
+    int sampled = psi_fd != -1 && psi_read_fd(psi_fd, &sample) == 0;
+
+    pthread_mutex_lock(&telemetry->lock);
+    // Symbol records reuse the sampler's last reading instead of reading PSI
+    if (sampled) {
+        telemetry->last_psi = sample;
+    }
+    rec->some_total_us = telemetry->last_psi.some.total;
+    rec->full_total_us = telemetry->last_psi.full.total;
+    rec->some_avg10 = telemetry->last_psi.some.avg10;
+    rec->symbol = telemetry->symbol;
+    rec->bit = telemetry->bit;
+    rec->bits = telemetry->bits;
+    rec->bit_errors = telemetry->bit_errors;
+    pthread_mutex_unlock(&telemetry->lock);
+}
+
+static void *sampler_main(void *arg) {
+    struct telemetry *telemetry = arg;
+    int psi_fd = psi_open(telemetry->pressure_path);
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!atomic_load(&telemetry->stop)) {
+        struct telemetry_record rec;
+        fill_record(telemetry, &rec, TELEMETRY_SAMPLE, psi_fd);
+        collect_stressors(telemetry, &rec);
+        publish(telemetry, &rec);
+
+        next.tv_nsec += telemetry->interval_ms * 1000000L;
+        next.tv_sec += next.tv_nsec / 1000000000L;
+        next.tv_nsec %= 1000000000L;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    if (psi_fd != -1) {
+        close(psi_fd);
+    }
+    return NULL;
+}
+
+void telemetry_open_from_env(struct telemetry *telemetry, const char *role) {
+    memset(telemetry, 0, sizeof(*telemetry));
+    telemetry->symbol = -1;
+    telemetry->pid = getpid();
+    snprintf(telemetry->role, sizeof(telemetry->role), "%s", role);
+    pthread_mutex_init(&telemetry->lock, NULL);
+
+    const char *name = getenv(TELEMETRY_ENV);
+    if (!name || name[0] == '\0') {
+        return;
+    }
+    const char *interval = getenv(TELEMETRY_INTERVAL_ENV);
+    telemetry->interval_ms = interval ? atol(interval) : TELEMETRY_DEFAULT_INTERVAL_MS;
+    if (telemetry->interval_ms <= 0) {
+        telemetry->interval_ms = TELEMETRY_DEFAULT_INTERVAL_MS;
+    }
+
+    telemetry->ring = map_ring(name);
+    if (!telemetry->ring) {
+        fprintf(stderr, "Telemetry ring %s unavailable, continuing without it\n", name);
+    }
+}
+
+void telemetry_watch(struct telemetry *telemetry, const char *pressure_path,
+                     const char *cgroup_path) {
+    if (!telemetry->ring || telemetry->sampler_running) {
+        return;
+    }
+    snprintf(telemetry->pressure_path, sizeof(telemetry->pressure_path), "%s", pressure_path);
+    snprintf(telemetry->cgroup_path, sizeof(telemetry->cgroup_path), "%s",
+             cgroup_path ? cgroup_path : "");
+    if (pthread_create(&telemetry->sampler, NULL, sampler_main, telemetry) == 0) {
+        telemetry->sampler_running = 1;
+    }
+}
+
+void telemetry_add_pid(struct telemetry *telemetry, pid_t pid) {
+    // Set up before telemetry_watch(); the sampler reads the list unlocked.
+    if (telemetry->nextra_pids < TELEMETRY_MAX_STRESSORS) {
+        telemetry->extra_pids[telemetry->nextra_pids++] = pid;
+    }
+}
+
+void telemetry_pressure(struct telemetry *telemetry, const struct psi_sample *sample) {
+    if (!telemetry->ring) {
+        return;
+    }
+    pthread_mutex_lock(&telemetry->lock);
+    telemetry->last_psi = *sample;
+    pthread_mutex_unlock(&telemetry->lock);
+}
+
+void telemetry_symbol(struct telemetry *telemetry, int64_t symbol, int bit, int error) {
+    if (!telemetry->ring) {
+        return;
+    }
+    pthread_mutex_lock(&telemetry->lock);
+    telemetry->symbol = symbol;
+    telemetry->bit = bit;
+    telemetry->bits++;
+    telemetry->bit_errors += error != 0;
+    pthread_mutex_unlock(&telemetry->lock);
+
+    // No PSI read here: symbol events must not add syscalls to the caller's path
+    struct telemetry_record rec;
+    fill_record(telemetry, &rec, TELEMETRY_SYMBOL, -1);
+    publish(telemetry, &rec);
+}
+
+void telemetry_close(struct telemetry *telemetry) {
+    if (telemetry->sampler_running) {
+        atomic_store(&telemetry->stop, 1);
+        pthread_join(telemetry->sampler, NULL);
+        telemetry->sampler_running = 0;
+    }
+    if (telemetry->ring) {
+        munmap(telemetry->ring, sizeof(struct telemetry_ring));
+        telemetry->ring = NULL;
+    }
+}
+
+const struct telemetry_ring *telemetry_map_readonly(const char *name) {
+    int fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+    if (fd == -1) {
+        return NULL;
+    }
+    void *mem = mmap(NULL, sizeof(struct telemetry_ring), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        return NULL;
+    }
+    const struct telemetry_ring *ring = mem;
+    if (atomic_load(&((struct telemetry_ring *)ring)->magic) != TELEMETRY_MAGIC ||
+        ring->version != TELEMETRY_VERSION) {
+        munmap(mem, sizeof(struct telemetry_ring));
+        return NULL;
+    }
+    return ring;
+}
+
+int telemetry_read(const struct telemetry_ring *ring, uint64_t index,
+                   struct telemetry_record *out) {
+    struct telemetry_record *slot =
+        (struct telemetry_record *)&ring->records[index & (TELEMETRY_SLOTS - 1)];
+
+    uint32_t before = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if (before == 0 || (before & 1)) {
+        return 0;  // never written, or the writer is inside
+    }
+    memcpy(out, slot, sizeof(*out));
+    atomic_thread_fence(memory_order_acquire);
+    uint32_t after = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    if (before != after || out->index < index) {
+        return 0;
+    }
+    return out->index == index ? 1 : -1;
+}
@@ -0,0 +1,142 @@
+/*
+ * Live telemetry through a named POSIX shared-memory ring.
+ *
+ * Replaces `watch -n 1 cat .../memory.pressure` and `watch -n 1 free -h`,
+ * which sample at 1 Hz and fork a process every second. When the
+ * PSI_TELEMETRY environment variable names a shared-memory object (e.g.
+ * PSI_TELEMETRY=/psicovert), every binary publishes records into that ring:
+ * a background thread samples PSI totals and the RSS of each stressor every
+ * PSI_TELEMETRY_INTERVAL_MS (default 10 ms), and symbol/bit events are
+ * published the moment they happen.
+ *
+ * Several processes can publish into the same ring. A writer claims a slot
+ * with an atomic increment of head and guards it with a per-slot sequence
+ * counter (odd while being written). TelemetryViewer maps the ring
+ * read-only and copies records out without any syscalls.
+ */
+#ifndef PSICOVERT_TELEMETRY_H
+#define PSICOVERT_TELEMETRY_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "psi.h"
+
+#define TELEMETRY_ENV "PSI_TELEMETRY"
+#define TELEMETRY_INTERVAL_ENV "PSI_TELEMETRY_INTERVAL_MS"
+#define TELEMETRY_DEFAULT_INTERVAL_MS 10
+#define TELEMETRY_MAGIC 0x50534954u  // "PSIT"
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_SLOTS 1024         // power of two
+#define TELEMETRY_MAX_STRESSORS 8
+#define TELEMETRY_ROLE_LEN 24
+#define TELEMETRY_PATH_LEN 256
+
+enum telemetry_kind {
+    TELEMETRY_SAMPLE = 0,  // periodic PSI/RSS sample
+    TELEMETRY_SYMBOL = 1,  // a symbol was sent or decoded
+};
+
+struct telemetry_record {
+    _Atomic uint32_t seq;  // odd while the writer is inside
+    uint32_t kind;
+    uint64_t index;        // ring position, lets readers detect being lapped
+    int64_t t_ns;          // CLOCK_MONOTONIC
+    int32_t pid;
+    char role[TELEMETRY_ROLE_LEN];
+    uint64_t some_total_us;
+    uint64_t full_total_us;
+    double some_avg10;
+    uint32_t nstressors;
+    int32_t stressor_pid[TELEMETRY_MAX_STRESSORS];
+    uint64_t stressor_rss_kb[TELEMETRY_MAX_STRESSORS];
+    int64_t symbol;        // -1 until the first symbol
+    int32_t bit;
+    uint64_t bits;         // symbols sent or decoded so far
+    uint64_t bit_errors;   // known only where the expected bits are known
+};
+
+struct telemetry_ring {
+    _Atomic uint32_t magic;
+    uint32_t version;
+    uint32_t slots;
+    _Atomic uint64_t head;  // next index to be claimed
+    struct telemetry_record records[TELEMETRY_SLOTS];
+};
+
+struct telemetry {
+    struct telemetry_ring *ring;  // NULL when telemetry is disabled
+    char role[TELEMETRY_ROLE_LEN];
+    pid_t pid;  // cached so symbol records cost no getpid() syscall
+    char pressure_path[TELEMETRY_PATH_LEN];
+    char cgroup_path[TELEMETRY_PATH_LEN];
+    pid_t extra_pids[TELEMETRY_MAX_STRESSORS];
+    int nextra_pids;
+    long interval_ms;
+    pthread_t sampler;
+    int sampler_running;
+    atomic_int stop;
+    pthread_mutex_t lock;  // protects the fields below against the sampler
+    int64_t symbol;
+    int bit;
+    uint64_t bits;
+    uint64_t bit_errors;
+    struct psi_sample last_psi;
+};
+
+/**
+ * Maps the ring named by $PSI_TELEMETRY, creating it if needed. Telemetry
+ * stays disabled (and every other call is a no-op) when the variable is
+ * unset or the ring cannot be mapped.
+ */
+void telemetry_open_from_env(struct telemetry *telemetry, const char *role);
+
+/**
+ * Starts the sampler thread. pressure_path is the PSI file to publish;
+ * cgroup_path (may be NULL) is scanned, including its child cgroups, for
+ * stressor PIDs.
+ */
+void telemetry_watch(struct telemetry *telemetry, const char *pressure_path,
+                     const char *cgroup_path);
+
+/**
+ * Adds a stressor PID that does not live in the watched cgroup. A process
+ * that forks its workers, like stress-ng, is published as its leaf
+ * descendants, which hold the memory, rather than as itself.
+ */
+void telemetry_add_pid(struct telemetry *telemetry, pid_t pid);
+
+/**
+ * Hands the caller's own PSI reading to the next records, for callers whose
+ * pressure does not come from a file the sampler can read (the simulated
+ * backend).
+ */
+void telemetry_pressure(struct telemetry *telemetry, const struct psi_sample *sample);
+
+/**
+ * Records a sent or decoded symbol and publishes it immediately.
+ * error is 1 for a known bit error, 0 otherwise.
+ */
+void telemetry_symbol(struct telemetry *telemetry, int64_t symbol, int bit, int error);
+
+/**
+ * Stops the sampler and unmaps the ring. The ring itself is left in place
+ * so the viewer can still read the final records.
+ */
+void telemetry_close(struct telemetry *telemetry);
+
+/**
+ * Reader side: maps an existing ring read-only. Returns NULL on failure.
+ */
+const struct telemetry_ring *telemetry_map_readonly(const char *name);
+
+/**
+ * Reader side: copies the record at index into out. Returns 1 on success,
+ * 0 if it is not written yet or being written, -1 if it was overwritten.
+ */
+int telemetry_read(const struct telemetry_ring *ring, uint64_t index,
+                   struct telemetry_record *out);
+
+#endif
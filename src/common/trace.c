@@ -0,0 +1,72 @@
+#include "trace.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+int trace_open(struct trace *trace, const char *path) {
+    trace->fp = NULL;
+    if (!path) {
+        return 0;
+    }
+    trace->fp = fopen(path, "we");
+    if (!trace->fp) {
+        return -1;
+    }
+    fprintf(trace->fp, "%s\n", TRACE_HEADER);
+    return 0;
+}
+
+void trace_tx(struct trace *trace, int64_t t_ns, long symbol, int bit) {
+    if (trace->fp) {
+        fprintf(trace->fp, "%" PRId64 "\ttx\t%ld\t%d\n", t_ns, symbol, bit);
+    }
+}
+
+void trace_rx(struct trace *trace, int64_t t_ns, long symbol, int bit,
+              unsigned long long some_us, unsigned long long full_us) {
+    if (trace->fp) {
+        fprintf(trace->fp, "%" PRId64 "\trx\t%ld\t%d\t%llu\t%llu\n",
+                t_ns, symbol, bit, some_us, full_us);
+    }
+}
+
+void trace_event(struct trace *trace, int64_t t_ns, const char *event, unsigned int pid,
+                 uint64_t cgroup_id, uint64_t arg0, uint64_t arg1) {
+    if (trace->fp) {
+        fprintf(trace->fp, "%" PRId64 "\t%s\t%u\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\n",
+                t_ns, event, pid, cgroup_id, arg0, arg1);
+    }
+}
+
+void trace_close(struct trace *trace) {
+    if (trace->fp) {
+        fclose(trace->fp);
+        trace->fp = NULL;
+    }
+}
+
+int trace_read(FILE *fp, struct trace_record *rec) {
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        char kind[32];
+        int offset = 0;
+        memset(rec, 0, sizeof(*rec));
+        if (line[0] == '#' ||
+            sscanf(line, "%" SCNd64 "\t%31s%n", &rec->t_ns, kind, &offset) < 2) {
+            continue;
+        }
+        // Kernel event lines carry 64-bit ids in the symbol/bit columns; skip them unparsed
+        if (strcmp(kind, "tx") == 0) {
+            rec->kind = TRACE_TX;
+        } else if (strcmp(kind, "rx") == 0) {
+            rec->kind = TRACE_RX;
+        } else {
+            continue;
+        }
+        if (sscanf(line + offset, "%ld\t%d\t%llu\t%llu", &rec->symbol, &rec->bit,
+                   &rec->some_us, &rec->full_us) >= 2) {
+            return 1;
+        }
+    }
+    return 0;
+}
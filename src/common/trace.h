@@ -0,0 +1,65 @@
+/*
+ * Plain-text symbol trace shared by sender and receiver.
+ *
+ * One record per line, tab separated, timestamps in CLOCK_MONOTONIC
+ * nanoseconds so traces from different processes line up:
+ *
+ *     # psicovert trace v1
+ *     <t_ns>  tx  <symbol>  <bit>
+ *     <t_ns>  rx  <symbol>  <bit>  <some_delta_us>  <full_delta_us>
+ *     <t_ns>  <event>  <pid>  <cgroup_id>  <arg0>  <arg1>
+ *
+ * Event lines come from the kernel tracer (PSITrace): event is one of
+ * psi_change (arg0/arg1: cleared/set task state flags), memstall_enter,
+ * memstall_leave, direct_reclaim_begin, memcg_reclaim_begin (order, gfp
+ * flags), direct_reclaim_end and memcg_reclaim_end (pages reclaimed).
+ */
+#ifndef PSICOVERT_TRACE_H
+#define PSICOVERT_TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define TRACE_HEADER "# psicovert trace v1"
+
+struct trace {
+    FILE *fp;
+};
+
+enum trace_kind {
+    TRACE_TX,
+    TRACE_RX,
+};
+
+struct trace_record {
+    int64_t t_ns;
+    enum trace_kind kind;
+    long symbol;
+    int bit;
+    unsigned long long some_us;  // rx only
+    unsigned long long full_us;  // rx only
+};
+
+/**
+ * Opens path for writing and emits the header. A NULL path leaves the trace
+ * disabled; every trace_* call is then a no-op. Returns 0 or -1.
+ */
+int trace_open(struct trace *trace, const char *path);
+
+void trace_tx(struct trace *trace, int64_t t_ns, long symbol, int bit);
+
+void trace_rx(struct trace *trace, int64_t t_ns, long symbol, int bit,
+              unsigned long long some_us, unsigned long long full_us);
+
+void trace_event(struct trace *trace, int64_t t_ns, const char *event, unsigned int pid,
+                 uint64_t cgroup_id, uint64_t arg0, uint64_t arg1);
+
+void trace_close(struct trace *trace);
+
+/**
+ * Reads the next tx or rx record, skipping comments and other kinds.
+ * Returns 1 on success, 0 at end of file.
+ */
+int trace_read(FILE *fp, struct trace_record *rec);
+
+#endif